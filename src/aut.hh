@@ -17,6 +17,8 @@
 #include "common/types.hh"
 #include "common/parity.hh"
 #include "common/bimap.hh"
+#include "metrics/counters.hh"
+#include "metrics/memstats.hh"
 
 namespace nbautils {
 using namespace std;
@@ -127,6 +129,7 @@ public:
   // add a new state (must have unused id)
   void add_state(state_t const s) {
     assert(!has_state(s));
+    MEM_SCOPE(adjacency);
 
     if (s != num_states()) { //not densely used state ids
       normalized = false;
@@ -195,6 +198,7 @@ public:
     assert(!has_edge(p,x,q));
 #endif
 
+    MEM_SCOPE(adjacency);
     adj.at(p)[x][q] = pri;
     if (pri>=0) {
       prio_cnt[pri]++;
@@ -571,27 +575,42 @@ adj_mat get_adjmat(auto const& aut) {
   return mat;
 }
 
+//reverse adjacency matrix: row q for symbol x has the x-predecessors of q
+inline adj_mat get_predmat(adj_mat const& mat) {
+  adj_mat pred(mat.size());
+  for (size_t x = 0; x < mat.size(); x++) {
+    auto const n = mat[x].size();
+    pred[x].resize(n, nba_bitset(0));
+    for (size_t p = 0; p < n; p++)
+      for (size_t q = 0; q < n; q++)
+        if (mat[x][p][q])
+          pred[x][q][p] = 1;
+  }
+  return pred;
+}
+
 //takes adj matrix, set of source states, transition symbol
 //a set of accepting sinks
 //a complete map of strict subsumptions (if bit i is set, &= with corresponding mask)
 //returns successors
-inline nba_bitset powersucc(adj_mat const& mat, nba_bitset from, sym_t x, nba_bitset sinks=0, map<unsigned,nba_bitset> impl_mask={}) {
+inline nba_bitset powersucc(adj_mat const& mat, nba_bitset const& from, sym_t x, nba_bitset const& sinks=0,
+                            map<unsigned,nba_bitset> const& impl_mask={}) {
   // cerr << pretty_bitset(from) << ", " << (int)x << endl;
+  COUNT(powersucc);
   nba_bitset ret = 0;
   auto const& xmat = mat[x];
   //collect all successors
-  for (int const i : ranges::view::ints(0, (int)ret.size())) {
-    if (from[i])
-      ret |= xmat[i];
-  }
+  for (auto i = from._Find_first(); i < from.size(); i = from._Find_next(i))
+    ret |= xmat[i];
   if ((ret & sinks) != 0) //reached acc sink
     return sinks;
 
-  //remove subsumed states
+  //remove subsumed states (masks can only clear bits, so the scan sees the current set)
   if (!impl_mask.empty())
-    for (int const i : ranges::view::ints(0, (int)ret.size())) {
-      if (ret[i] && map_has_key(impl_mask, (unsigned)i))
-        ret &= impl_mask[i];
+    for (auto i = ret._Find_first(); i < ret.size(); i = ret._Find_next(i)) {
+      auto const it = impl_mask.find(i);
+      if (it != impl_mask.end())
+        ret &= it->second;
     }
 
   return ret;
@@ -0,0 +1,99 @@
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "cache.hh"
+
+namespace nbautils {
+using namespace std;
+
+uint64_t fnv1a_hash(string const& s) {
+  uint64_t h = 14695981039346656037ULL;
+  for (unsigned char const c : s) {
+    h ^= c;
+    h *= 1099511628211ULL;
+  }
+  return h;
+}
+
+string with_hoa_name(string const& hoa, string const& name) {
+  size_t const start = hoa.find("\nname: ");
+  if (start == string::npos)
+    return hoa;
+  size_t const end = hoa.find('\n', start+1);
+  return hoa.substr(0, start+1) + "name: \"" + name + "\"" + hoa.substr(end);
+}
+
+string without_hoa_state_names(string const& hoa) {
+  stringstream in(hoa);
+  string ret, line;
+  while (getline(in, line)) {
+    size_t const first = line.find('"');
+    if (line.compare(0, 7, "State: ") == 0 && first != string::npos)
+      line.erase(first-1, line.rfind('"') - first + 2);
+    ret += line + "\n";
+  }
+  return ret;
+}
+
+ResultCache::ResultCache(string const& directory) : dir(directory) {
+  if (mkdir(dir.c_str(), 0777) != 0 && errno != EEXIST)
+    throw runtime_error("Can not create cache directory " + dir + ": " + strerror(errno) + "!");
+}
+
+constexpr int ResultCache::format_version;
+
+string ResultCache::salted(string const& key) {
+  return "nbautils-cache v" + to_string(format_version) + "\n" + key;
+}
+
+string ResultCache::path_for(string const& key) const {
+  char hex[17];
+  snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(fnv1a_hash(key)));
+  return dir + "/" + hex;
+}
+
+// entry format: "<length of key>\n<key><result>"
+bool ResultCache::lookup(string const& rawkey, string& result) const {
+  string const key = salted(rawkey);
+  ifstream in(path_for(key), ios::binary);
+  if (!in)
+    return false;
+
+  size_t keylen = 0;
+  if (!(in >> keylen) || in.get() != '\n' || keylen != key.size())
+    return false;
+
+  string storedkey(keylen, '\0');
+  if (!in.read(&storedkey[0], keylen) || storedkey != key)
+    return false; //hash collision or broken entry
+
+  stringstream ss;
+  ss << in.rdbuf();
+  result = ss.str();
+  return true;
+}
+
+void ResultCache::store(string const& rawkey, string const& result) const {
+  string const key = salted(rawkey);
+  string const path = path_for(key);
+  string const tmp = path + ".tmp" + to_string(getpid());
+  {
+    ofstream out(tmp, ios::binary);
+    out << key.size() << "\n" << key << result;
+    if (!out) {
+      remove(tmp.c_str());
+      return; //cache is best effort
+    }
+  }
+  if (rename(tmp.c_str(), path.c_str()) != 0)
+    remove(tmp.c_str());
+}
+
+}  // namespace nbautils
@@ -0,0 +1,190 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <sstream>
+#include <vector>
+#include <map>
+#include <tuple>
+#include <algorithm>
+
+#include "aut.hh"
+
+// content-addressed on-disk cache for results computed from automata.
+// automata are brought into a canonical numbering first, so that inputs
+// differing only in the names of their states share one cache entry.
+
+namespace nbautils {
+using namespace std;
+
+// colors of states that are preserved by isomorphism: starting from given colors,
+// split classes by priority, whether the state is initial and the colors of the
+// successors (per symbol and edge priority) until no class is split anymore.
+// colors are numbered in order of their signatures, not depending on state ids.
+template<typename T>
+void refine_colors(Aut<T> const& aut, map<state_t, size_t>& col) {
+  using succ_t = tuple<sym_t, size_t, pri_t>;
+  using sig_t = tuple<pri_t, bool, size_t, vector<succ_t>>;
+
+  size_t numcols = 0;
+  while (true) {
+    map<state_t, sig_t> sig;
+    for (auto const p : aut.states()) {
+      vector<succ_t> sucs;
+      for (auto const x : aut.state_outsyms(p))
+        for (auto const& es : aut.succ_edges(p, x))
+          sucs.emplace_back(x, col.at(es.first), es.second);
+      sort(begin(sucs), end(sucs));
+      pri_t const pri = aut.is_sba() && aut.has_pri(p) ? aut.get_pri(p) : -1;
+      sig[p] = make_tuple(pri, p == aut.get_init(), col.at(p), move(sucs));
+    }
+
+    map<sig_t, size_t> ids;
+    for (auto const& it : sig)
+      ids[it.second] = 0;
+    size_t i = 0;
+    for (auto& it : ids)
+      it.second = i++;
+    for (auto const& it : sig)
+      col[it.first] = ids.at(it.second);
+
+    if (ids.size() == numcols) //stable
+      break;
+    numcols = ids.size();
+  }
+}
+
+// renumber states in BFS order from the initial state, visiting successors by symbol.
+// new successors of a state under the same symbol are ordered by their refined color.
+// if some of them have the same color, the one with least old id gets a color
+// of its own and the colors are refined again, which usually separates the others.
+// unreachable states are appended in the same way, starting from the least color.
+// so the form is the same for isomorphic automata, unless some ties remain between
+// states that are not symmetric (rare, then it still is the same for the same automaton).
+template<typename T>
+Aut<T> canonical_form(Aut<T> const& aut) {
+  map<state_t, size_t> col;
+  for (auto const p : aut.states())
+    col[p] = 0;
+  refine_colors(aut, col);
+
+  auto const less = [&](state_t a, state_t b){
+    return make_pair(col.at(a), a) < make_pair(col.at(b), b);
+  };
+  //give q a color of its own, if it shares its color with other states in given range
+  auto const individualize = [&](auto first, auto last, state_t q) {
+    if (none_of(first, last, [&](state_t r){ return r != q && col.at(r) == col.at(q); }))
+      return false;
+    col[q] = col.size();
+    refine_colors(aut, col);
+    return true;
+  };
+
+  map<state_t, state_t> m;
+  vector<state_t> order;
+  auto const visit = [&](state_t s) {
+    if (!map_has_key(m, s)) {
+      m[s] = order.size();
+      order.push_back(s);
+    }
+  };
+
+  vector<state_t> const sts = aut.states() | ranges::to_vector;
+  visit(aut.get_init());
+  for (size_t i = 0; i < sts.size(); i++) {
+    if (i == order.size()) { //continue with unreachable part
+      vector<state_t> rest;
+      for (auto const q : sts)
+        if (!map_has_key(m, q))
+          rest.push_back(q);
+      sort(begin(rest), end(rest), less);
+      while (individualize(begin(rest), end(rest), rest.front()))
+        sort(begin(rest), end(rest), less);
+      visit(rest.front());
+    }
+
+    auto const p = order[i];
+    for (auto const x : aut.state_outsyms(p)) {
+      vector<state_t> fresh;
+      for (auto const& es : aut.succ_edges(p, x))
+        if (!map_has_key(m, es.first))
+          fresh.push_back(es.first);
+      for (auto it = begin(fresh); it != end(fresh); ++it) {
+        sort(it, end(fresh), less);
+        while (individualize(it, end(fresh), *it))
+          sort(it, end(fresh), less);
+        visit(*it);
+      }
+    }
+  }
+
+  Aut<T> ret(aut.is_sba(), aut.get_name(), aut.get_aps(), 0);
+  ret.set_patype(aut.get_patype());
+  ret.tag_to_str = aut.tag_to_str;
+  for (auto const p : order) {
+    if (!ret.has_state(m.at(p)))
+      ret.add_state(m.at(p));
+    if (aut.tag.hasi(p))
+      ret.tag.put(aut.tag.geti(p), m.at(p));
+    if (aut.is_sba() && aut.has_pri(p))
+      ret.set_pri(m.at(p), aut.get_pri(p));
+  }
+  for (auto const p : order)
+    for (auto const x : aut.state_outsyms(p))
+      for (auto const& es : aut.succ_edges(p, x))
+        ret.add_edge(m.at(p), x, m.at(es.first), es.second);
+
+  return ret;
+}
+
+// serialize everything that determines the language (and numbering) of an automaton:
+// APs, acceptance, initial state, priorities and edges. name and tags are ignored.
+template<typename T>
+string structure_key(Aut<T> const& aut) {
+  stringstream ss;
+  ss << "aps " << aut.get_aps().size();
+  for (auto const& ap : aut.get_aps())
+    ss << " " << ap.size() << ":" << ap;
+  ss << "\nsba " << aut.is_sba() << " patype " << static_cast<int>(aut.get_patype())
+     << " init " << aut.get_init() << " states " << aut.num_states() << "\n";
+  for (auto const p : aut.states()) {
+    ss << p;
+    if (aut.is_sba() && aut.has_pri(p))
+      ss << " {" << aut.get_pri(p) << "}";
+    for (auto const x : aut.state_outsyms(p))
+      for (auto const& es : aut.succ_edges(p, x))
+        ss << " " << x << ">" << es.first << "," << es.second;
+    ss << "\n";
+  }
+  return ss.str();
+}
+
+uint64_t fnv1a_hash(string const& s);
+
+// replace the name in the header of an automaton printed by print_aut
+string with_hoa_name(string const& hoa, string const& name);
+
+// remove the state names from an automaton printed by print_aut
+string without_hoa_state_names(string const& hoa);
+
+// maps keys to results, one file per key hash in the cache directory.
+// the full key is stored with the result, so hash collisions are detected.
+// entries are written atomically, so concurrent processes can share a directory.
+class ResultCache {
+  string dir;
+  string path_for(string const& key) const;
+
+  // prefixed to all keys. increment whenever canonical_form, structure_key
+  // or the stored results change, so that old entries are not used anymore
+  static constexpr int format_version = 3;
+  static string salted(string const& key);
+
+public:
+  // creates the directory if missing, throws if that is not possible
+  explicit ResultCache(string const& directory);
+
+  bool lookup(string const& key, string& result) const;
+  void store(string const& key, string const& result) const;
+};
+
+}  // namespace nbautils
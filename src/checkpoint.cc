@@ -0,0 +1,113 @@
+#include <stdexcept>
+
+#include "checkpoint.hh"
+
+namespace nbautils {
+using namespace std;
+
+BinWriter::BinWriter(string const& filename) : out(filename, ios::binary | ios::trunc) {
+  if (!out)
+    throw runtime_error("cannot write checkpoint " + filename + "!");
+}
+
+void BinWriter::u64(uint64_t v) {
+  out.write(reinterpret_cast<char const*>(&v), sizeof(v));
+}
+
+void BinWriter::str(string const& s) {
+  u64(s.size());
+  out.write(s.data(), s.size());
+}
+
+void BinWriter::bits(nba_bitset const& b) {
+  for (size_t w = 0; w < b.size(); w += 64) {
+    uint64_t word = 0;
+    for (size_t i = 0; i < 64; i++)
+      if (b[w + i])
+        word |= uint64_t(1) << i;
+    u64(word);
+  }
+}
+
+void BinWriter::slice(ranked_slice const& rs) {
+  u64(rs.size());
+  for (auto const& it : rs) {
+    bits(it.first);
+    i64(it.second);
+  }
+}
+
+void BinWriter::detstate(DetState const& ds) {
+  bits(ds.powerset);
+  bits(ds.nsccs);
+  bits(ds.asccs_buf);
+  bits(ds.asccs);
+  i64(ds.asccs_pri);
+  u64(ds.dsccs.size());
+  for (auto const& rs : ds.dsccs)
+    slice(rs);
+  u64(ds.msccs.size());
+  for (auto const& rs : ds.msccs)
+    slice(rs);
+}
+
+void BinWriter::close() {
+  out.flush();
+  if (!out)
+    throw runtime_error("writing checkpoint failed!");
+  out.close();
+}
+
+BinReader::BinReader(string const& filename) : in(filename, ios::binary) {}
+
+uint64_t BinReader::u64() {
+  uint64_t v;
+  if (!in.read(reinterpret_cast<char*>(&v), sizeof(v)))
+    throw runtime_error("checkpoint is truncated!");
+  return v;
+}
+
+string BinReader::str() {
+  string s(u64(), '\0');
+  if (!in.read(&s[0], s.size()))
+    throw runtime_error("checkpoint is truncated!");
+  return s;
+}
+
+nba_bitset BinReader::bits() {
+  nba_bitset b = 0;
+  for (size_t w = 0; w < b.size(); w += 64) {
+    uint64_t const word = u64();
+    for (size_t i = 0; i < 64; i++)
+      if ((word >> i) & 1)
+        b[w + i] = 1;
+  }
+  return b;
+}
+
+ranked_slice BinReader::slice() {
+  ranked_slice rs(u64());
+  for (auto& it : rs) {
+    it.first = bits();
+    it.second = i64();
+  }
+  return rs;
+}
+
+DetState BinReader::detstate() {
+  DetState ds;
+  ds.powerset = bits();
+  ds.nsccs = bits();
+  ds.asccs_buf = bits();
+  ds.asccs = bits();
+  ds.asccs_pri = i64();
+  ds.dsccs.resize(u64());
+  for (auto& rs : ds.dsccs)
+    rs = slice();
+  ds.msccs.resize(u64());
+  for (auto& rs : ds.msccs)
+    rs = slice();
+  return ds;
+}
+
+}  // namespace nbautils
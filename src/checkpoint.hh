@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <fstream>
+
+#include "common/types.hh"
+#include "detstate.hh"
+
+// binary streams for checkpoints of long running explorations.
+// the format is only meant to be read back by the same build on the same machine type.
+// all read errors (truncated or foreign files) throw runtime_error.
+
+namespace nbautils {
+using namespace std;
+
+class BinWriter {
+  ofstream out;
+
+public:
+  explicit BinWriter(string const& filename);
+
+  void u64(uint64_t v);
+  void i64(int64_t v) { u64(static_cast<uint64_t>(v)); }
+  void str(string const& s);
+  void bits(nba_bitset const& b);
+  void slice(ranked_slice const& rs);
+  void detstate(DetState const& ds);
+
+  // flush and check that everything was written
+  void close();
+};
+
+class BinReader {
+  ifstream in;
+
+public:
+  explicit BinReader(string const& filename);
+
+  bool is_open() const { return in.is_open(); }
+
+  uint64_t u64();
+  int64_t i64() { return static_cast<int64_t>(u64()); }
+  string str();
+  nba_bitset bits();
+  ranked_slice slice();
+  DetState detstate();
+};
+
+}  // namespace nbautils
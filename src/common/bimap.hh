@@ -5,6 +5,9 @@
 #include <memory>
 #include <iostream>
 
+#include "metrics/counters.hh"
+#include "metrics/memstats.hh"
+
 namespace nbautils {
 using namespace std;
 
@@ -31,42 +34,64 @@ struct bimap {
 
 // the concrete instances:
 
+// keys are stored only once: the reverse map points to the keys in ktov,
+// which stay in place as M is node-based (map or unordered_map)
 template <typename K, typename V, template <typename... Args> class M>
 class naive_bimap : public bimap<K, V, naive_bimap<K, V, M>> {
   M<K, V> ktov;
-  M<V, K> vtok;
+  M<V, K const*> vtok;
+
+  void relink() {
+    vtok.clear();
+    for (auto const& it : ktov)
+      vtok[it.second] = &it.first;
+  }
 
  public:
+  naive_bimap() = default;
+  naive_bimap(naive_bimap const& other) : ktov(other.ktov) { relink(); }
+  naive_bimap(naive_bimap&&) = default;
+  naive_bimap& operator=(naive_bimap const& other) {
+    ktov = other.ktov;
+    relink();
+    return *this;
+  }
+  naive_bimap& operator=(naive_bimap&&) = default;
 
   size_t size() const { return ktov.size(); }
 
   bool has(K const& k) const { return ktov.find(k) != end(ktov); }
   bool hasi(V const& v) const { return vtok.find(v) != end(vtok); }
   V get(K const& k) const { return ktov.at(k); }
-  K geti(V const& v) const { return vtok.at(v); }
+  K const& geti(V const& v) const { return *vtok.at(v); }
 
   //if key has other value, return existing value
   V put_or_get(K const& k, V const& v) {
-    if (has(k)) return ktov.at(k);
-    ktov[k] = v;
-    vtok[v] = k;
+    auto const it = ktov.find(k);
+    if (it != end(ktov)) {
+      COUNT(bimap_hit);
+      return it->second;
+    }
+    COUNT(bimap_miss);
+    MEM_SCOPE(tags);
+    vtok[v] = &ktov.emplace(k, v).first->first;
     return v;
   }
 
   //if key or value associated otherwise, remove old link
   void put(K const& k, V const& v) {
+    MEM_SCOPE(tags);
     erasei(v);
     if (has(k)) erasei(get(k));
-    ktov[k] = v;
-    vtok[v] = k;
+    vtok[v] = &ktov.emplace(k, v).first->first;
   }
 
   //remove value
   void erasei(V const& v) {
-    if (!hasi(v)) return;
-    auto const k = geti(v);
-    ktov.erase(ktov.find(k));
-    vtok.erase(vtok.find(v));
+    auto const it = vtok.find(v);
+    if (it == end(vtok)) return;
+    ktov.erase(ktov.find(*it->second));
+    vtok.erase(it);
   }
 };
 
@@ -0,0 +1,216 @@
+#include <iostream>
+#include <cstdio>
+#include <cerrno>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include <new>
+
+#include <unistd.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+
+#include "jobs.hh"
+
+namespace nbautils {
+using namespace std;
+
+namespace {
+
+// exit codes of worker processes
+int const exit_ok = 0;
+int const exit_failed = 1;
+int const exit_memout = 2;
+int const exit_aborted = 3;
+
+}  // namespace
+
+void write_all(int fd, string const& s) {
+  size_t off = 0;
+  while (off < s.size()) {
+    ssize_t const n = ::write(fd, s.data() + off, s.size() - off);
+    if (n < 0) {
+      if (errno == EINTR)
+        continue;
+      return;
+    }
+    off += n;
+  }
+}
+
+string to_string(JobStatus st) {
+  switch (st) {
+    case JobStatus::ok: return "ok";
+    case JobStatus::failed: return "failed";
+    case JobStatus::timeout: return "timeout";
+    case JobStatus::memout: return "out of memory";
+    case JobStatus::aborted: return "aborted";
+  }
+  return "";
+}
+
+JobPool::JobPool(unsigned numworkers, JobLimits lim)
+  : workers(max(1u, numworkers)), limits(lim) {
+  //a worker dying with unread output must not kill us
+  signal(SIGPIPE, SIG_IGN);
+}
+
+JobPool::~JobPool() {
+  for (auto& r : running) {
+    kill(r.pid, SIGKILL);
+    close(r.fd);
+    waitpid(r.pid, nullptr, 0);
+  }
+}
+
+size_t JobPool::submit(function<string()> f) {
+  while (running.size() >= workers)
+    poll_once();
+
+  int fds[2];
+  if (pipe(fds) != 0)
+    throw runtime_error(string("pipe failed: ") + strerror(errno) + "!");
+
+  //do not duplicate buffered output into the child
+  cout.flush();
+  cerr.flush();
+  fflush(nullptr);
+
+  int const pid = fork();
+  if (pid < 0) {
+    close(fds[0]);
+    close(fds[1]);
+    throw runtime_error(string("fork failed: ") + strerror(errno) + "!");
+  }
+
+  if (pid == 0) { //worker
+    close(fds[0]);
+    for (auto const& r : running)
+      close(r.fd);
+
+    if (limits.memory) {
+      rlimit rl;
+      rl.rlim_cur = rl.rlim_max = limits.memory;
+      setrlimit(RLIMIT_AS, &rl);
+    }
+
+    int code = exit_ok;
+    try {
+      write_all(fds[1], f());
+    } catch (std::bad_alloc const&) {
+      code = exit_memout;
+    } catch (JobAborted const& e) {
+      write_all(fds[1], e.what());
+      code = exit_aborted;
+    } catch (std::exception const& e) {
+      write_all(fds[1], e.what());
+      code = exit_failed;
+    }
+    close(fds[1]);
+    cerr.flush();
+    _exit(code); //no destructors or atexit handlers of the parent state
+  }
+
+  close(fds[1]);
+  running.push_back(Running{next_id, pid, fds[0], clock::now(), ""});
+  return next_id++;
+}
+
+void JobPool::finish(size_t i, bool killed) {
+  Running& r = running[i];
+  if (killed)
+    kill(r.pid, SIGKILL);
+  close(r.fd);
+
+  int st = 0;
+  while (waitpid(r.pid, &st, 0) < 0 && errno == EINTR) {}
+
+  JobResult res;
+  res.id = r.id;
+  res.secs = chrono::duration<double>(clock::now() - r.start).count();
+  if (killed)
+    res.status = JobStatus::timeout;
+  else if (WIFEXITED(st) && WEXITSTATUS(st) == exit_ok)
+    res.status = JobStatus::ok;
+  else if (WIFEXITED(st) && WEXITSTATUS(st) == exit_memout)
+    res.status = JobStatus::memout;
+  else if (WIFEXITED(st) && WEXITSTATUS(st) == exit_aborted)
+    res.status = JobStatus::aborted;
+  else
+    res.status = JobStatus::failed;
+
+  if (res.status == JobStatus::ok || res.status == JobStatus::failed
+      || res.status == JobStatus::aborted)
+    res.output = move(r.output);
+  done.emplace(res.id, move(res));
+
+  running.erase(running.begin() + i);
+}
+
+//wait until some worker produced output, terminated or exceeded its time
+//(or just check for that, if not blocking)
+void JobPool::poll_once(bool block) {
+  if (running.empty())
+    return;
+
+  int wait_ms = block ? -1 : 0;
+  if (block && limits.timeout > 0) {
+    auto const now = clock::now();
+    double left = limits.timeout;
+    for (auto const& r : running)
+      left = min(left, limits.timeout - chrono::duration<double>(now - r.start).count());
+    wait_ms = max(0, static_cast<int>(left * 1000) + 1);
+  }
+
+  vector<pollfd> pfds;
+  for (auto const& r : running)
+    pfds.push_back(pollfd{r.fd, POLLIN, 0});
+
+  int const n = poll(pfds.data(), pfds.size(), wait_ms);
+  if (n < 0 && errno != EINTR)
+    throw runtime_error(string("poll failed: ") + strerror(errno) + "!");
+
+  //indices are stable as long as we go from the back
+  char buf[1 << 16];
+  for (size_t i = running.size(); i-- > 0;) {
+    if (n <= 0 || !pfds[i].revents)
+      continue;
+
+    ssize_t const got = read(running[i].fd, buf, sizeof(buf));
+    if (got > 0)
+      running[i].output.append(buf, got);
+    else if (got == 0 || errno != EINTR)
+      finish(i, false);
+  }
+
+  if (limits.timeout > 0) {
+    auto const now = clock::now();
+    for (size_t i = running.size(); i-- > 0;)
+      if (chrono::duration<double>(now - running[i].start).count() >= limits.timeout)
+        finish(i, true);
+  }
+}
+
+void JobPool::reap() { poll_once(false); }
+
+bool JobPool::has_result() const { return done.find(next_out) != done.end(); }
+
+bool JobPool::pending() const { return next_out < next_id; }
+
+JobResult JobPool::next_result() {
+  if (!pending())
+    throw runtime_error("No pending jobs!");
+
+  while (!has_result())
+    poll_once();
+
+  auto it = done.find(next_out);
+  JobResult res = move(it->second);
+  done.erase(it);
+  ++next_out;
+  return res;
+}
+
+}  // namespace nbautils
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <map>
+#include <functional>
+#include <chrono>
+#include <stdexcept>
+
+// pool of forked worker processes for batch processing.
+// each job runs in its own child (so it can be killed on timeout and be
+// restricted in address space), its output is sent back through a pipe
+// and results are handed out in submission order.
+
+namespace nbautils {
+using namespace std;
+
+struct JobLimits {
+  double timeout = 0;  // seconds per job, 0 = unlimited
+  size_t memory = 0;   // bytes of address space per job, 0 = unlimited
+};
+
+enum class JobStatus { ok, failed, timeout, memout, aborted };
+string to_string(JobStatus st);
+
+// thrown by a job that gave up by itself on exceeding some limit (status aborted)
+struct JobAborted : public runtime_error {
+  using runtime_error::runtime_error;
+};
+
+struct JobResult {
+  size_t id = 0;
+  JobStatus status = JobStatus::failed;
+  string output; //error message (if any) for failed jobs
+  double secs = 0;
+};
+
+// write whole string to file descriptor (retrying on short writes)
+void write_all(int fd, string const& s);
+
+class JobPool {
+  using clock = std::chrono::steady_clock;
+
+  struct Running {
+    size_t id;
+    int pid;
+    int fd;
+    clock::time_point start;
+    string output;
+  };
+
+  unsigned workers;
+  JobLimits limits;
+
+  size_t next_id = 0;     // id for next submitted job
+  size_t next_out = 0;    // id of next result to be handed out
+  vector<Running> running;
+  map<size_t, JobResult> done;
+
+  void finish(size_t i, bool killed);
+  void poll_once(bool block=true);
+
+public:
+  JobPool(unsigned numworkers, JobLimits lim);
+  ~JobPool();
+  JobPool(JobPool const&) = delete;
+  JobPool& operator=(JobPool const&) = delete;
+
+  // run f in a new worker, blocking while all workers are busy.
+  // f is executed in the child, its return value is the job output.
+  // throwing std::bad_alloc counts as running out of memory, JobAborted as aborted.
+  // returns id of the job (ids are consecutive, starting at 0)
+  size_t submit(function<string()> f);
+
+  // collect workers that terminated meanwhile (without blocking), so that they
+  // do not linger as zombies. their results are handed out by next_result as usual
+  void reap();
+
+  // whether the next result in submission order is already available
+  bool has_result() const;
+  // whether there are submitted jobs whose result was not handed out yet
+  bool pending() const;
+  // wait for the next result in submission order (requires pending())
+  JobResult next_result();
+};
+
+}  // namespace nbautils
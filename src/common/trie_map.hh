@@ -3,6 +3,9 @@
 #include <unordered_map>
 #include <memory>
 #include <vector>
+#include <algorithm>
+
+#include "metrics/memstats.hh"
 
 namespace nbautils {
 
@@ -12,7 +15,7 @@ template <typename K, typename V>
 struct trie_node {
   using node_ptr = unique_ptr<trie_node<K, V>>;
 
-  // trie_node* parent = nullptr;
+  trie_node* parent = nullptr;
   K key = 0;
   unique_ptr<V> value = nullptr;
 
@@ -24,6 +27,7 @@ class trie_map {
   using node_t = trie_node<K, V>;
   node_t root;
   size_t sz = 0;
+  vector<node_t*> valued; //nodes with value, in order of first assignment
 
  public:
 
@@ -36,7 +40,7 @@ class trie_map {
       if (curr->suc.find(ks[i]) == curr->suc.end()) {
         if (create) {
           curr->suc[ks[i]] = make_unique<node_t>();
-          // curr->suc[ks[i]]->parent = curr;
+          curr->suc[ks[i]]->parent = curr;
           curr->suc[ks[i]]->key = ks[i];
         } else
           return nullptr;
@@ -50,13 +54,31 @@ class trie_map {
 
   // puts a set,value pair
   void put(vector<K> const &ks, V val) {
+    MEM_SCOPE(trie);
     auto curr = traverse(ks, true);
     if (curr->value)
       --sz;
+    else
+      valued.push_back(curr);
     curr->value = make_unique<V>(val);
     ++sz;
   }
 
+  // call f(keys, value) for all entries in the order they were first put.
+  // putting them in this order into an empty trie gives the same structure
+  // (including iteration order of the successor maps)
+  template <typename F>
+  void for_each_entry(F f) const {
+    vector<K> ks;
+    for (auto const* nod : valued) {
+      ks.clear();
+      for (auto const* curr = nod; curr != &root; curr = curr->parent)
+        ks.push_back(curr->key);
+      reverse(ks.begin(), ks.end());
+      f(ks, *(nod->value));
+    }
+  }
+
   bool has(vector<K> const &ks, bool subtree=false) {
     auto const *curr = traverse(ks, false);
     if (!curr)
@@ -10,6 +10,7 @@
 #include <set>
 #include <unordered_set>
 #include <queue>
+#include <deque>
 #include <string>
 #include <sstream>
 #include <cassert>
@@ -231,32 +232,47 @@ std::vector<std::vector<T>> group_by(std::vector<T> v, F const& f) {
 //pusher function on all successors that also need to be visited.
 //bfs keeps track that each node is visited once in bfs order automatically.
 //TODO: maybe make something with "process_edge, give_edges" ?
-template <typename Node, typename F>
-void bfs(Node const& start, F visit) {
-  std::queue<Node> bfsq;
+//the state of a bfs is kept in a BFSState, so that it can be inspected between visits
+//(e.g. to save and restore it). the variant with start node uses a fresh one.
+template <typename Node>
+struct BFSState {
+  std::deque<Node> queue;
   std::unordered_set<Node> visited;
   std::unordered_set<Node> discovered;
 
-  auto pusher = [&](Node const& st){
+  void push(Node const& st) {
     if (!contains(discovered, st)) {
       discovered.emplace(st);
-      bfsq.push(st);
+      queue.push_back(st);
     }
-  };
-  auto visited_f = [&](Node const& el){ return contains(visited, el); };
+  }
+};
+
+//continue bfs from given state, calling between() before taking the next node
+template <typename Node, typename F, typename G>
+void bfs(BFSState<Node>& s, F visit, G between) {
+  auto pusher = [&](Node const& st){ s.push(st); };
+  auto visited_f = [&](Node const& el){ return contains(s.visited, el); };
   // auto discovered_f = [&](T const& el){ return contains(visited, el); };
 
-  pusher(start);
-  while (!bfsq.empty()) {
-    auto const st = bfsq.front();
-    bfsq.pop();
-    if (visited.find(st) != visited.end()) continue;  // have visited this one
-    visited.emplace(st);
+  while (!s.queue.empty()) {
+    between();
+    auto const st = s.queue.front();
+    s.queue.pop_front();
+    if (s.visited.find(st) != s.visited.end()) continue;  // have visited this one
+    s.visited.emplace(st);
 
     visit(st, pusher, visited_f /*, discovered_f */);
   }
 }
 
+template <typename Node, typename F>
+void bfs(Node const& start, F visit) {
+  BFSState<Node> s;
+  s.push(start);
+  bfs(s, visit, [](){});
+}
+
 //iteratively double param, then use binary search to minimize it
 template <typename T, typename F>
 auto find_min_param(T mn, T mx, F func) {
@@ -43,25 +43,21 @@ using ComplAut = Aut<ComplTag>;
 *
 *	This method returns the largest value in a slice-vector that is assigned to the x-predecessor in nba of the given state.
 *
-*	\param nba	The automaton, whose states define the elements of &preSlice and in which the x-predecessors are defined. In the context of Buechi-complementation, this is the input-automaton.
+*	\param pred	The reverse adjacency-matrix of the automaton, whose states define the elements of &preSlice (see get_predmat() in aut.hh). In the context of Buechi-complementation, this belongs to the input-automaton.
 *	\param state	The state, for which the largest x-predecessor should be determined.
 *	\param x		The letter, via which the predecessors are connected to focused state in the automaton nba.
 *	\param preSlice	Pointer to the slice-vector that contains the values, from which the largest slice-value for the x-predecessors of the given state is chosen.
 *
 *	\return		The largest value in &preSlice for an x-predecessor of the given state.
 */
-//TODO: this should be replaced with precomputed predecessors
-signed long get_largest_predecessor(auto const& nba, state_t state, sym_t x, vector<signed long>* preSlice){
+inline signed long get_largest_predecessor(adj_mat const& pred, state_t state, sym_t x, vector<signed long>* preSlice){
 	signed long largest = -1;
+	auto const& preds = pred[x][state];
 
-	for(auto i : nba.states()){
-
-		// Go through all successors of i for symbol x
-		for(auto& scope : nba.succ(i, x)){
-
-			if(scope == state && preSlice->operator[](i) != -1 && largest < preSlice->operator[](i)){
-				largest = preSlice->operator[](i);
-			}
+	// Go through all x-predecessors of state
+	for(state_t i = 0; i < preSlice->size(); i++){
+		if(preds[i] && preSlice->operator[](i) != -1 && largest < preSlice->operator[](i)){
+			largest = preSlice->operator[](i);
 		}
 	}
 	return largest;
@@ -72,17 +68,14 @@ signed long get_largest_predecessor(auto const& nba, state_t state, sym_t x, vec
 
 
 // Currently not needed, only for mirrored version of the slice-reduction!
-signed long get_lowest_predecessor(auto const& nba, state_t state, sym_t x, vector<signed long>* preSlice){
+inline signed long get_lowest_predecessor(adj_mat const& pred, state_t state, sym_t x, vector<signed long>* preSlice){
 	signed long lowest = -1;
+	auto const& preds = pred[x][state];
 
-	for(auto i : nba.states()){
-
-		// Go through all successors of i for symbol x
-		for(auto& scope : nba.succ(i, x)){
-
-			if(scope == state && preSlice->operator[](i) != -1 && (lowest == -1 || lowest > preSlice->operator[](i))){
-				lowest = preSlice->operator[](i);
-			}
+	// Go through all x-predecessors of state
+	for(state_t i = 0; i < preSlice->size(); i++){
+		if(preds[i] && preSlice->operator[](i) != -1 && (lowest == -1 || lowest > preSlice->operator[](i))){
+			lowest = preSlice->operator[](i);
 		}
 	}
 	return lowest;
@@ -90,60 +83,129 @@ signed long get_lowest_predecessor(auto const& nba, state_t state, sym_t x, vect
 
 
 /**
-*	\brief	Returns a normalized a slice-vector.
+*	\brief	Upper bound (exclusive) for values in slices and rankings, including intermediate values.
+*/
+size_t const max_rank_value = 2*max_nba_states + 2;
+
+/**
+*	\brief	Normalizes a slice in-place.
 *
-*	Normalized a slice-vector such that every value between 0 and the highest value
-*	does appear in the vector.
+*	Normalizes a slice such that every value between 0 and the highest value
+*	does appear in it.
 *	Since slices define pre-orders, different vectors representing the same pre-order
-*	result in the same normalized slice-vector.
-*	This normalization allows to easily check whether two given slice-vectors represent the same pre-order:
-*	If they do, then their normalized slice-vectors are identical.
+*	result in the same normalized slice.
+*	This normalization allows to easily check whether two given slices represent the same pre-order:
+*	If they do, then their normalized slices are identical.
+*	Each value is replaced by the number of smaller values that appear in the slice.
+*
+*	\param slice	The slice that should be normalized.
+*/
+inline void normalize_slice(RankArr& slice){
+	signed long const maxVal = slice.max_value();
+	assert(maxVal < (signed long)max_rank_value);
+
+	// Mark values that appear, then replace each value by the number of smaller values that appear
+	array<int16_t, max_rank_value> newVal;
+	fill(newVal.begin(), newVal.begin() + maxVal + 1, 0);
+	for(auto const v : slice){
+		if(v != -1){ newVal[v] = 1; }
+	}
+	int16_t count = 0;
+	for(signed long v = 0; v <= maxVal; v++){
+		int16_t const appears = newVal[v];
+		newVal[v] = count;
+		count += appears;
+	}
+
+	for(unsigned i = 0; i < slice.size(); i++){
+		if(slice[i] != -1){ slice[i] = newVal[slice[i]]; }
+	}
+}
+
+/**
+*	\brief	Returns a normalized a slice-vector, see normalize_slice(RankArr&).
 *
 *	\param slice	A pointer to the slice-vector that should be normalized.
 *
 *	\return	The normalized slice-vector.
 */
-vector<signed long> normalize_slice(vector<signed long>* slice){
+inline vector<signed long> normalize_slice(vector<signed long>* slice){
+	auto arr = RankArr::from_vector(*slice);
+	normalize_slice(arr);
+	return arr.to_vector();
+}
+
+
+
+
+/////////// STS CONSTRUCTION /////////////////////////////////////////////////////////////////////////
+/**
+*	\brief	Generates the x-successor of a slice in the Slice-Transition-System (STS).
+*
+*	Each state of the successor-slice is placed according to its largest x-predecessor in the current slice,
+*	which is found by scanning only the bits of its predecessors that are contained in the current slice.
+*
+*	\param nba		The automaton, whose states are used as elements of the slices. In the context of Buechi-complementation, this is the input-automaton.
+*	\param mat		Adjacency-matrix of nba.
+*	\param pred		Reverse adjacency-matrix of nba, see get_predmat() in aut.hh.
+*	\param curset	The stateSet of the current slice.
+*	\param curSlice	The current slice.
+*	\param x		The letter, for which the successor should be determined.
+*	\param sinks	Defines sinks of the input-automaton, see sts_construction().
+*
+*	\return	The slice-ComplTag of the x-successor.
+*/
+ComplTag succ_slice(auto const& nba, adj_mat const& mat, adj_mat const& pred, nba_bitset const& curset, RankArr const& curSlice, sym_t x, nba_bitset const& sinks=0){
+	auto const sucset = powersucc(mat, curset, x, sinks);
 
-	vector<signed long> resSlice;
-	long offset = 0;
+	// Calculate successor-slice
+	RankArr tempSlice(curSlice.size());
 
-	// Store the offset for each value at its position in a vector (will be substracted later)
-	vector<signed long> offsetVector;
-	for(auto i = 0; i <= *max_element(slice->begin(), slice->end()); i++){
-		if(find(slice->begin(), slice->end(), i) == slice->end()){
-			offset++;
+	for(auto q : nba.states()){
+		if(!sucset[q]){continue;}	// State not part of the slice
+
+		// State is part of the slice, determine its position in the preorder
+		nba_bitset const preds = pred[x][q] & curset;
+		signed long largest = -1;
+		for(size_t p = preds._Find_first(); p < preds.size(); p = preds._Find_next(p)){
+			if(curSlice[p] > largest){ largest = curSlice[p]; }
 		}
-		offsetVector.push_back(offset);
-	}
 
-	// "Tighten" the slice to normalize it unique by substracting offset
-	for(state_t i = 0; i < slice->size(); i++){
-		if(slice->operator[](i) == -1){
-			resSlice.push_back(-1);
+		assert(largest != -1);
+
+		if(nba.get_pri(q) == 0){	// Final state
+			tempSlice[q] = 2*largest + 1;
 		}
-		else{
-			resSlice.push_back(slice->operator[](i) - offsetVector[slice->operator[](i)]);
+		else{						// Non-final state
+			tempSlice[q] = 2*largest;
 		}
 	}
 
-	return resSlice;
+	// Create the tag for the successor (the stateSet is determined by the slice)
+	// The slice is "normalized" to make it unique; necessary for testing if a certain slice already exists
+	normalize_slice(tempSlice);
+	ComplTag tag;
+	tag.set_state_type('s');
+	tag.set_state_set(sucset);
+	tag.set_slice(tempSlice);
+
+	return tag;
 }
 
 
 
 
-/////////// STS CONSTRUCTION /////////////////////////////////////////////////////////////////////////
 /**
 *	\brief	Constructs a Slice-Transition-System (STS).
 *
 *	\param nba		The automaton, for which the STS should be constructed. In the context of Buechi-complementation, this is the input-automaton.
 *	\param mat		Adjacency-matrix of nba.
+*	\param pred		Reverse adjacency-matrix of nba, see get_predmat() in aut.hh.
 *	\param sinks	Defines sinks of the input-automaton and does not define any sinks if the parameter is undefined. This parameter is only used as a parameter for the function powersucc() in aut.hh.
 *
 *	\return The STS as a ComplTag-automaton.
 */
-ComplAut sts_construction(auto const& nba, adj_mat const& mat, nba_bitset const& sinks=0){
+ComplAut sts_construction(auto const& nba, adj_mat const& mat, adj_mat const& pred, nba_bitset const& sinks=0){
 	assert(nba.is_buchi());
 
 	// Create automaton, add initial state, and associate with initial states in original aut
@@ -155,78 +217,37 @@ ComplAut sts_construction(auto const& nba, adj_mat const& mat, nba_bitset const&
 
 	// Create tag for initial state
 	ComplTag initTag;
-	initTag.stateType = 's';
-	initTag.stateSet = nba_bitset(1<<nba.get_init());
+	initTag.set_state_type('s');
+	initTag.set_state_set(nba_bitset(1<<nba.get_init()));
 	// Fill slice of initial state
+	vector<signed long> initSlice;
 	for(auto i : nba.states()){
-		if(i == nba.get_init())	{initTag.slice.push_back(0);}		// Only initial state is in the initial slice
-		else					{initTag.slice.push_back(-1);}		// Give dummy value to all non-slice states
+		if(i == nba.get_init())	{initSlice.push_back(0);}		// Only initial state is in the initial slice
+		else					{initSlice.push_back(-1);}		// Give dummy value to all non-slice states
 	}
+	initTag.set_slice(initSlice);
 	// Add initial tag
 	sts.tag.put(initTag, 0);
 
 
    bfs(myinit, [&](auto const& st, auto const& visit, auto const&) {
     // get inner states of current sts state
-    auto const curset = sts.tag.geti(st).stateSet;
-	vector<signed long> curSlice = sts.tag.geti(st).slice;
+    auto const curset = sts.tag.geti(st).get_state_set();
+	RankArr curSlice;
+	sts.tag.geti(st).get_slice(curSlice);
     // calculate successors and add to graph
     for (auto const i : sts.syms()) {		// Go through the letters in the alphabet
-		auto const sucset = powersucc(mat, curset, i, sinks);
-
-		// Calculate successor-slice
-		vector<signed long> tempSlice;
-
-		// Known: curset, curSlice, sucset
-		// Now compute sucSlice!
-
-		for(auto x : nba.states()){
-			if(sucset[x] == 0){			// State not part of the slice
-				tempSlice.push_back(-1);
-			}
-			else{						// State is part of the slice, determine its position in the preorder
-				auto largest = get_largest_predecessor(nba, x, i, &curSlice);
-
-				assert(largest != -1);
-
-				if(nba.get_pri(x) == 0){	// Final state
-					tempSlice.push_back(2*largest + 1);
-				}
-				else{						// Non-final state
-					tempSlice.push_back(2*largest);
-				}
-			}
-		}
-
-		// "Normalize" the slice to make it unique; necessary for testing if a certain slice already exists
-		auto sucSlice = normalize_slice(&tempSlice);
-
+		ComplTag const ct2 = succ_slice(nba, mat, pred, curset, curSlice, i, sinks);
 
-
-        //TODO: this should be done using tag.put_or_get(...)
 		// Check if sucSlice does already exist
-		bool tagKnown = false;			// Is used to determine whether a tag with a certain stateSet exists
-		unsigned int tagFoundAt = 0;	// If a tag with a certain stateSet exists, this variable stores the according state
-
-		for(auto j : sts.states()){
-			if(sts.tag.geti(j).slice == sucSlice){
-				tagKnown = true;
-				tagFoundAt = j;
-				break;
-			}
-		}
+		bool const tagKnown = sts.tag.has(ct2);			// Is used to determine whether a tag with a certain slice exists
+		unsigned int const tagFoundAt = tagKnown ? sts.tag.get(ct2) : 0;	// If a tag with a certain slice exists, this variable stores the according state
 
 
-	  // If the stateSet sucset is unknown, add a state with sucset as its stateSet
+	  // If the slice sucSlice is unknown, add a state with it
       if (!tagKnown){
-		// Add a new state
+		// Add a new state and set the tag
         sts.add_state(sts.num_states());
-
-		// Create and set a tag for the new state
-		ComplTag ct2;
-		ct2.stateType = 's';		// This will be a state in stage 1
-		ct2.stateSet = sucset;
-		ct2.slice = sucSlice;
 		sts.tag.put(ct2, sts.num_states()-1);
 	  }
 
@@ -249,6 +270,10 @@ ComplAut sts_construction(auto const& nba, adj_mat const& mat, nba_bitset const&
   return sts;
 }
 
+ComplAut sts_construction(auto const& nba, adj_mat const& mat, nba_bitset const& sinks=0){
+	return sts_construction(nba, mat, get_predmat(mat), sinks);
+}
+
 
 
 
@@ -259,65 +284,83 @@ ComplAut sts_construction(auto const& nba, adj_mat const& mat, nba_bitset const&
 *	Convert a given slice to a ranking via "torank"-function from
 *	the paper "Unifying Buechi Complementation Constructions" (see page 16).
 *	The input-automaton nba is necessary to be able to distinguish between final and non-final states.
+*	The beta-value of a state is the number of positions above its own position that contain a non-final state,
+*	which is computed for all positions at once.
 *
 *	\param nba	The automaton, whose states are used as elements of the given slice. In the context of Buechi-complementation, this is the input-automaton.
-*	\param slice	The slice-vector that should be transformed to a ranking.
-*
-*	\return	A ranking-vector for the given slice-vector.
+*	\param slice	The slice that should be transformed to a ranking.
+*	\param rank	Is set to the ranking for the given slice.
 */
-vector<signed long> slice_to_rank(auto const& nba, vector<signed long> slice){
-
-	vector<signed long> rank;		// Empty rank-vector
-
-	// Fill rank-vector with the according ranking-values for each state.
-	for(unsigned long i = 0; i < slice.size(); i++){
-
-		signed long beta = 0;		// The beta-value for state i, initially 0
-
-		// Test if the current state is actually in slice
-		if(slice[i] == -1){
-			rank.push_back(-1);
-			continue;
-		}
-
-		// Find the actual beta-value for the current state i:
-		// For each position greater than the one of i, look if there is a non-final state at this position.
-		// If so, increase the beta-value of i by 1.
-		for(signed long x = *max_element(slice.begin(), slice.end()); x > slice[i]; x--){
-
-			for(unsigned long j = 0; j < slice.size(); j++){
-
-				if(slice[j] == x && nba.get_pri(j) == 1){
-					beta++;
-					break;
-				}
+void slice_to_rank(auto const& nba, RankArr const& slice, RankArr& rank){
+	signed long const maxVal = slice.max_value();
+	assert(maxVal < (signed long)max_rank_value);
+
+	// Mark positions that contain a non-final state
+	array<int16_t, max_rank_value> beta;
+	fill(beta.begin(), beta.begin() + maxVal + 1, 0);
+	for(unsigned j = 0; j < slice.size(); j++){
+		if(slice[j] != -1 && nba.get_pri(j) == 1){ beta[slice[j]] = 1; }
+	}
+	// beta-value for each position: number of marked positions above it
+	int16_t count = 0;
+	for(signed long x = maxVal; x >= 0; x--){
+		int16_t const nonfinal = beta[x];
+		beta[x] = count;
+		count += nonfinal;
+	}
 
-			}
+	rank.len = slice.size();
+	for(unsigned i = 0; i < slice.size(); i++){
+		if(slice[i] == -1){			// State is not in slice
+			rank[i] = -1;
 		}
-
-		// Current state is part of slice, now give it its rank
-		if(nba.get_pri(i) == 0){	// Final state
-			rank.push_back(2*beta);
+		else if(nba.get_pri(i) == 0){	// Final state
+			rank[i] = 2*beta[slice[i]];
 		}
 		else{						// Non-final state
-			rank.push_back(2*beta+1);
+			rank[i] = 2*beta[slice[i]] + 1;
 		}
-
 	}
-
-	return rank;
 }
 
+/**
+*	\brief	Converts a slice-vector to a ranking-vector, see slice_to_rank(auto const&, RankArr const&, RankArr&).
+*
+*	\param nba	The automaton, whose states are used as elements of the given slice. In the context of Buechi-complementation, this is the input-automaton.
+*	\param slice	The slice-vector that should be transformed to a ranking.
+*
+*	\return	A ranking-vector for the given slice-vector.
+*/
+vector<signed long> slice_to_rank(auto const& nba, vector<signed long> slice){
+	RankArr rank;
+	slice_to_rank(nba, RankArr::from_vector(slice), rank);
+	return rank.to_vector();
+}
 
 
 
 
+/**
+*	\brief	Returns the ranking-ComplTag for a slice-ComplTag, i.e. the target of a type-2 transition.
+*
+*	\param nba	The automaton, whose states are used as elements of the slice. In the context of Buechi-complementation, this is the input-automaton.
+*	\param sliceTag	The slice-ComplTag.
+*
+*	\return	A ranking-ComplTag with the ranking of the slice and an empty obligationSet.
+*/
+ComplTag slice_tag_to_ranking(auto const& nba, ComplTag const& sliceTag){
+	RankArr slice, rank;
+	sliceTag.get_slice(slice);
+	slice_to_rank(nba, slice, rank);
 
-
-
-
-
-
+	// Ranking-tag for the slice (the stateSet is determined by the ranking)
+	ComplTag tag;
+	tag.set_state_type('r');
+	tag.set_state_set(sliceTag.get_state_set());
+	tag.set_ranking(rank);
+	tag.set_obligation_set(0);
+	return tag;
+}
 
 
 
@@ -343,33 +386,19 @@ ComplAut add_type2_trans_sts(ComplAut const& sts, auto const& nba){
 
 			for(auto& suc : sts.succ(i, x)){		// Go through all x-successors (only one, since STS is deterministic)
 
-				// Generate ranking for that slice
-				vector<signed long> ranking = slice_to_rank(nba, sts.tag.geti(suc).slice);
-				bool tagKnown = false;
-				unsigned long tagFoundAt;
+				// Generate ranking-tag for that slice (the stateSet is determined by the ranking)
+				ComplTag const tag = slice_tag_to_ranking(nba, sts.tag.geti(suc));
 
 				// Test if this ranking does already exist
-				for(auto& j : res.states()){
-					if(res.tag.geti(j).stateType == 'r' && res.tag.geti(j).ranking == ranking){
-						tagKnown = true;
-						tagFoundAt = j;
-						break;
-					}
-				}
+				bool const tagKnown = res.tag.has(tag);
 
 				// Modify output-automaton
 				if(tagKnown){			// Ranking is already known, only add edge
+					unsigned long const tagFoundAt = res.tag.get(tag);
                   if (!res.has_edge(i,x,tagFoundAt))
 					res.add_edge(i, x, tagFoundAt);
 				}
 				else{					// Ranking is new, add state, tag and edge to new state
-					ComplTag tag;
-					tag.stateType = 'r';
-
-					tag.stateSet = res.tag.geti(suc).stateSet;
-					tag.ranking = ranking;
-					tag.obligationSet = 0;
-
 					res.add_state(res.num_states());
 					res.add_edge(i,x,res.num_states()-1);
 					res.tag.put(tag, res.num_states()-1);
@@ -384,51 +413,61 @@ ComplAut add_type2_trans_sts(ComplAut const& sts, auto const& nba){
 
 
 /**
-*	\brief	Tightens a ranking-vector.
+*	\brief	Tightens a ranking in-place.
 *
 *	Tightens a ranking according to the textual description of the tighten-function on page 17 of
 *	the paper "Unifying Buechi Complementation Constructions".
 *	For the formal definition, refer to "Optimization for the Complementation of Buechi Automata".
 *	The nba as input-automaton is primarily used to determine which states are final.
+*	The gamma-value of a rank (the number of odd ranks below it that appear in the ranking) is computed for all ranks at once.
 *
 *	\param nba	The automaton, for whose states the given ranking is defined.
-*	\param ranking	The pointer to the ranking-vector, that should be tightened.
-*
-*	\return	A tight ranking-vector.
+*	\param ranking	The ranking that should be tightened.
 */
-vector<signed long> tighten_ranking(auto const& nba, vector<signed long>* ranking){
-
-	vector<signed long> tightRanking;
-
-	for(auto& i : nba.states()){
+void tighten_ranking(auto const& nba, RankArr& ranking){
+	signed long const maxVal = ranking.max_value();
+	assert(maxVal < (signed long)max_rank_value);
+
+	// Mark odd ranks that appear, then compute gamma for each rank
+	array<int16_t, max_rank_value> gamma;
+	fill(gamma.begin(), gamma.begin() + maxVal + 1, 0);
+	for(auto const r : ranking){
+		if(r != -1 && r % 2 == 1){ gamma[r] = 1; }
+	}
+	int16_t count = 0;
+	for(signed long r = 0; r <= maxVal; r++){
+		int16_t const odd = gamma[r];
+		gamma[r] = count;
+		count += odd;
+	}
 
+	for(auto const i : nba.states()){
 		// Case 1: If the ranking of state i is -1 in the input ranking, it also is -1 in the tight ranking
-		if(ranking->operator[](i) == -1){
-			tightRanking.push_back(-1);
-			continue;
-		}
-
-		// Determine gamma-value for each state i of the input-automaton
-		unsigned long gamma = 0;
-		for(signed long j = 1; j < ranking->operator[](i); j += 2){
-			if(find(ranking->begin(), ranking->end(), j) != ranking->end()){
-				gamma++;
-			}
-		}
+		if(ranking[i] == -1){continue;}
 
-		// Add ranking value
-		if(nba.get_pri(i) == 0 || ranking->operator[](i) % 2 == 0){	// Case 2: i is a final state
+		if(nba.get_pri(i) == 0 || ranking[i] % 2 == 0){	// Case 2: i is a final state
 			// The 2nd case is not defined clearly in the source-paper, but solves the correctness problem
-			tightRanking.push_back(2*gamma);
+			ranking[i] = 2*gamma[ranking[i]];
 		}
 		else{						// Case 3: i is a non-final state
-			tightRanking.push_back(2*gamma + 1);
+			ranking[i] = 2*gamma[ranking[i]] + 1;
 		}
 	}
-
-	return tightRanking;
 }
 
+/**
+*	\brief	Tightens a ranking-vector, see tighten_ranking(auto const&, RankArr&).
+*
+*	\param nba	The automaton, for whose states the given ranking is defined.
+*	\param ranking	The pointer to the ranking-vector, that should be tightened.
+*
+*	\return	A tight ranking-vector.
+*/
+vector<signed long> tighten_ranking(auto const& nba, vector<signed long>* ranking){
+	auto arr = RankArr::from_vector(*ranking);
+	tighten_ranking(nba, arr);
+	return arr.to_vector();
+}
 
 
 
@@ -443,63 +482,63 @@ vector<signed long> tighten_ranking(auto const& nba, vector<signed long>* rankin
 *	For details of a successor-ranking and successor-obligation-sets, refer to page 17 of the paper "Unifying Buechi Complementation Constructions".
 *
 *	\param nba	The automaton, from which the states for the ranking originate. In the context of Buechi-complementation, this is the input-NBW that should be complemented.
+*	\param mat	Adjacency-matrix of nba.
+*	\param pred	Reverse adjacency-matrix of nba, see get_predmat() in aut.hh.
 *	\param curTag	The ComplTag that includes the ranking, for which the successor should be computed.
 *	\param x	The letter that defines which successor-ranking should be determined for curTag.
 *
 *	\return	The x-successor ComplTag of the ranking-ComplTag curTag.
 */
-ComplTag succ_ranking(auto const& nba, ComplTag curTag, sym_t x){
-	assert(curTag.stateType == 'r');
+ComplTag succ_ranking(auto const& nba, adj_mat const& mat, adj_mat const& pred, ComplTag const& curTag, sym_t x){
+	assert(curTag.get_state_type() == 'r');
 
 	ComplTag tag;
-	vector<signed long> succ_ranking;
 	bitset<max_nba_states> succ_obSet;
 
+	RankArr curRanking;
+	curTag.get_ranking(curRanking);
+
+	// States with a ranking different from -1
+	nba_bitset ranked = 0;
+	for(state_t j = 0; j < curRanking.size(); j++){
+		if(curRanking[j] != -1){
+			ranked.set(j);
+		}
+	}
+
 	// Generate ranking-value for each state of the given nba
+	RankArr succRanking(curRanking.size());
 	for(auto& i : nba.states()){
 
-		vector<state_t> pred;	// Vector of x-predecessors of state i with a ranking different from -1
+		// x-predecessors of state i with a ranking different from -1
+		nba_bitset const preds = pred[x][i] & ranked;
 
-		// Fill pred
-		for(auto& j : nba.states()){
-			// Is there a way to directly check if an element is in a given range?
-			for(auto const p : nba.succ(j, x)){
-				if(i == p && curTag.ranking[j] != -1){
-					pred.push_back(j);
-				}
-			}
-		}
+		// Case 1 (no predecessors): ranking stays -1
+		if(preds == 0){continue;}
 
-		// Calculate ranking value for state i
-		if(pred.size() == 0){			// Case 1 (pred is empty)
-			succ_ranking.push_back(-1);
-			continue;
-		}
-		else{							// Case 2 and 3 (pred is not empty)
-			signed long smallestRanking = -1;
-			// Find smallest ranking among predecessors
-			for(unsigned long p = 0; p < pred.size(); p++){
-				if(smallestRanking == -1 || smallestRanking > curTag.ranking[pred[p]]){
-					smallestRanking = curTag.ranking[pred[p]];
-				}
-			}
-			// Case 2: Substract 1, if i is final state and smallestRanking is odd
-			if(nba.get_pri(i) == 0 && smallestRanking % 2 == 1){
-				smallestRanking--;
+		// Case 2 and 3 (there are predecessors): find smallest ranking among predecessors
+		signed long smallestRanking = -1;
+		for(size_t p = preds._Find_first(); p < preds.size(); p = preds._Find_next(p)){
+			if(smallestRanking == -1 || smallestRanking > curRanking[p]){
+				smallestRanking = curRanking[p];
 			}
-			succ_ranking.push_back(smallestRanking);
 		}
+		// Case 2: Substract 1, if i is final state and smallestRanking is odd
+		if(nba.get_pri(i) == 0 && smallestRanking % 2 == 1){
+			smallestRanking--;
+		}
+		succRanking[i] = smallestRanking;
 	}
 
 	// Tighten the successor-ranking
-	auto tight_succ = tighten_ranking(nba, &succ_ranking);
+	tighten_ranking(nba, succRanking);
 
 	// Calculate obligation-set for the successor-ranking
-	if(curTag.obligationSet != 0){		// Non-empty Obligation-Set (Case 1)
-		// New obligation set is Delta(curTag.obligationSet, x) without odd(succ_ranking)
-		succ_obSet = powersucc(get_adjmat(nba), curTag.obligationSet, x);
+	if(curTag.get_obligation_set() != 0){		// Non-empty Obligation-Set (Case 1)
+		// New obligation set is Delta(curTag.get_obligation_set(), x) without odd(succ_ranking)
+		succ_obSet = powersucc(mat, curTag.get_obligation_set(), x);
 		for(auto& i : nba.states()){
-			if(tight_succ[i] % 2 == 1 && tight_succ[i] != -1){
+			if(succRanking[i] % 2 == 1 && succRanking[i] != -1){
 				succ_obSet.reset(i);
 			}
 		}
@@ -507,21 +546,26 @@ ComplTag succ_ranking(auto const& nba, ComplTag curTag, sym_t x){
 	else{								// Empty Obligation-Set (Case 2)
 		// Add all states with even rank to the new obligation set
 		for(auto& i : nba.states()){
-			if(tight_succ[i] % 2 == 0){
+			if(succRanking[i] % 2 == 0){
 				succ_obSet.set(i);
 			}
 		}
 	}
 
 	// Fill output-tag with information
-	tag.stateType = 'r';
-	tag.stateSet = powersucc(get_adjmat(nba), curTag.stateSet, x);
-	tag.ranking = tight_succ;
-	tag.obligationSet = succ_obSet;
+	tag.set_state_type('r');
+	tag.set_state_set(powersucc(mat, curTag.get_state_set(), x));
+	tag.set_ranking(succRanking);
+	tag.set_obligation_set(succ_obSet);
 
 	return tag;
 }
 
+ComplTag succ_ranking(auto const& nba, ComplTag const& curTag, sym_t x){
+	auto const mat = get_adjmat(nba);
+	return succ_ranking(nba, mat, get_predmat(mat), curTag, x);
+}
+
 
 
 
@@ -533,36 +577,31 @@ ComplTag succ_ranking(auto const& nba, ComplTag curTag, sym_t x){
 *
 *	\param comp	The ComplTag-automaton, on which the returned automaton is based. It should contain type-1 and type-2 transitions, if this method is called in the context of Buechi-complementation.
 *	\param nba 	The input-automaton that should be complemented.
+*	\param mat	Adjacency-matrix of nba.
+*	\param pred	Reverse adjacency-matrix of nba.
 *
 *	\return	A ComplTag automaton with type-3 transitions, i.e. all ranking-successors have been added for already existing ranking-states and ranking-states that were created in the process.
 */
-ComplAut add_type3_trans(ComplAut const& comp, auto const& nba){
+ComplAut add_type3_trans(ComplAut const& comp, auto const& nba, adj_mat const& mat, adj_mat const& pred){
 
 	ComplAut res = comp;
 
 	bfs(res.get_init(), [&](auto const& st, auto const& visit, auto const&) {
 		if(st == comp.get_init()){for(auto& i : comp.states()){visit(i);}}		// Add all existing states to visit
 
-		if(res.tag.geti(st).stateType != 'r'){return;}		// Only ranking-states are of interest
+		if(res.tag.geti(st).get_state_type() != 'r'){return;}		// Only ranking-states are of interest
 
 		// Generate the x-successor of state st for each x in the alphabet
 		for(auto const x : res.syms()){
 
-			auto succ_tag = succ_ranking(nba, res.tag.geti(st), x);		// Get tag for x-successor of st
+			auto succ_tag = succ_ranking(nba, mat, pred, res.tag.geti(st), x);		// Get tag for x-successor of st
 
 			// Check if succ_tag does already exist
-			bool tagKnown = false;
-			unsigned long tagFoundAt;
-			for(auto& i : res.states()){
-				if(res.tag.geti(i).ranking == succ_tag.ranking && res.tag.geti(i).obligationSet == succ_tag.obligationSet){
-					tagKnown = true;
-					tagFoundAt = i;
-					break;
-				}
-			}
+			bool const tagKnown = res.tag.has(succ_tag);
 
 			// Modify output-automaton
 			if(tagKnown){			// Ranking is already known, only add edge
+				unsigned long const tagFoundAt = res.tag.get(succ_tag);
 				res.add_edge(st, x, tagFoundAt);
 				visit(tagFoundAt);
 			}
@@ -592,9 +631,9 @@ ComplAut add_type3_trans(ComplAut const& comp, auto const& nba){
 *
 *	\param aut	Pointer to the ComplTag-automaton, for which acceptance should be added.
 */
-void add_acceptance(Aut<ComplTag>* aut){
+inline void add_acceptance(Aut<ComplTag>* aut){
 	for(auto& i : aut->states()){
-		if(aut->tag.geti(i).stateType == 'r' && aut->tag.geti(i).obligationSet == 0){
+		if(aut->tag.geti(i).get_state_type() == 'r' && aut->tag.geti(i).get_obligation_set() == 0){
 			aut->set_pri(i, 0);		// Ranking-states with empty Obligation-Set are final
 		}
 		else{
@@ -619,14 +658,17 @@ void add_acceptance(Aut<ComplTag>* aut){
 ComplAut al_construction(auto const& nba, adj_mat const& mat){
 	assert(nba.is_buchi());
 
+	// Predecessors are needed in both stages, compute them once
+	auto const pred = get_predmat(mat);
+
 	// Create the STS for the given input-automaton nba
-	auto STS = sts_construction(nba, mat);
+	auto STS = sts_construction(nba, mat, pred);
 
 	// Create automaton from STS that contains transitions of type 2 (slice to ranking) and the according ranking-states
 	auto temp = add_type2_trans_sts(STS, nba);
 
 	// Add transitions between rankings and the according states
-	auto AL = add_type3_trans(temp, nba);
+	auto AL = add_type3_trans(temp, nba, mat, pred);
 
 	// Add acceptance-property to states (final or non-final)
 	add_acceptance(&AL);
@@ -60,40 +60,31 @@ ComplAut compl_ps_construction(auto const& nba, adj_mat const& mat, nba_bitset c
   };
 
   ComplTag ct1;					//'p', nba_bitset(1<<nba.get_init()), nba_bitset(1<<nba.get_init()));
-  ct1.stateType = 'p';			// This will be a state in stage 1
-  ct1.stateSet = nba_bitset(1<<nba.get_init());
+  ct1.set_state_type('p');			// This will be a state in stage 1
+  ct1.set_state_set(nba_bitset(1<<nba.get_init()));
   ps.tag.put(ct1, myinit);
 
 
   bfs(myinit, [&](auto const& st, auto const& visit, auto const&) {
     // Get inner states of current ps state
-    auto const curset = ps.tag.geti(st).stateSet;
+    auto const curset = ps.tag.geti(st).get_state_set();
     // Calculate successors and add to graph
     for (auto const i : ps.syms()) {
       auto const sucset = powersucc(mat, curset, i, sinks);
 
-		bool tagKnown = false;			// Is used to determine whether a tag with a certain stateSet exists
-		unsigned int tagFoundAt = 0;	// If a tag with a certain stateSet exists, this variable stores the according state
+		// Create the tag for the successor
+		ComplTag ct2;
+		ct2.set_state_type('p');		// This will be a state in stage 1
+		ct2.set_state_set(sucset);
 
-		// Since tag stores pointers as values, this ugly approach is used instead of put_or_get()
-		for(auto j : ps.states()){
-			if(ps.tag.geti(j).stateSet == sucset){
-				tagKnown = true;
-				tagFoundAt = j;
-				break;
-			}
-		}
+		bool const tagKnown = ps.tag.has(ct2);			// Is used to determine whether a tag with a certain stateSet exists
+		unsigned int const tagFoundAt = tagKnown ? ps.tag.get(ct2) : 0;	// If a tag with a certain stateSet exists, this variable stores the according state
 
 
 		// If the stateSet sucset is unknown, add a state with sucset as its stateSet
 		if (!tagKnown){
-			// Add a new state
+			// Add a new state and set the tag
 			ps.add_state(ps.num_states());
-
-			// Create and set a tag for the new state
-			ComplTag ct2;
-			ct2.stateType = 'p';		// This will be a state in stage 1
-			ct2.stateSet = sucset;
 			ps.tag.put(ct2, ps.num_states()-1);
 		}
 
@@ -129,13 +120,15 @@ ComplAut compl_ps_construction(auto const& nba, adj_mat const& mat, nba_bitset c
 *
 *	\param ps	The powerset-ComplTag-automaton of nba.
 *	\param nba	The nba, for which the powerset-automaton was created. In the context of Buechi-complementation, this is the input-automaton.
+*	\param mat	Adjacency-matrix of nba.
+*	\param pred	Reverse adjacency-matrix of nba.
 *
 *	\return	A ComplTag-automaton, that consists of the powerset-automaton and type-2 transitions, including the according ranking states.
 */
-ComplAut add_type2_trans_ps(ComplAut ps, auto const& nba){
+ComplAut add_type2_trans_ps(ComplAut ps, auto const& nba, adj_mat const& mat, adj_mat const& pred){
 
 	// Create STS to find out which slices are reachable
-	auto sts = sts_construction(nba, get_adjmat(nba));
+	auto sts = sts_construction(nba, mat, pred);
 
 	state_t stateRange = ps.num_states();
 
@@ -147,32 +140,19 @@ ComplAut add_type2_trans_ps(ComplAut ps, auto const& nba){
 			for(auto& succ : ps.succ(p, x)){
 				//Determine successor in sts and add ranking for it to ps
 				for(auto& s : sts.states()){//(auto& suc : sts.succ(s, x)){
-					if(ps.tag.geti(succ).stateSet == sts.tag.geti(s).stateSet){
-						vector<signed long> ranking = slice_to_rank(nba, sts.tag.geti(s).slice);
-						bool tagKnown = false;
-						unsigned long tagFoundAt;
+					if(ps.tag.geti(succ).get_state_set() == sts.tag.geti(s).get_state_set()){
+						// Ranking-tag for the slice (the stateSet is determined by the ranking)
+						ComplTag const tag = slice_tag_to_ranking(nba, sts.tag.geti(s));
 
 						// Check if the ranking is already known (i.e., if the according state already exists)
-						for(auto& j : ps.states()){
-							if(ps.tag.geti(j).stateType == 'r' && ps.tag.geti(j).ranking == ranking){
-								tagKnown = true;
-								tagFoundAt = j;
-								break;
-							}
-						}
+						bool const tagKnown = ps.tag.has(tag);
 
 						if(tagKnown){		// Ranking is already known, only add edge
+							unsigned long const tagFoundAt = ps.tag.get(tag);
                           if (!ps.has_edge(p,x,tagFoundAt))
 							ps.add_edge(p, x, tagFoundAt);
 						}
 						else{				// Ranking is new, add state, tag and edge to new state
-							ComplTag tag;
-							tag.stateType = 'r';
-
-							tag.stateSet = ps.tag.geti(succ).stateSet;
-							tag.ranking = ranking;
-							tag.obligationSet = 0;
-
 							ps.add_state(ps.num_states());
 							ps.add_edge(p,x,ps.num_states()-1);
 							ps.tag.put(tag, ps.num_states()-1);
@@ -202,14 +182,17 @@ ComplAut add_type2_trans_ps(ComplAut ps, auto const& nba){
 ComplAut compl_construction(auto const& nba, adj_mat const& mat){
 	assert(nba.is_buchi());
 
+	// Predecessors are needed in both stages, compute them once
+	auto const pred = get_predmat(mat);
+
 	// Create the Powerset-automaton for the given input-automaton nba
 	auto PS = compl_ps_construction(nba, mat);
 
 	// Create automaton from PS that contains transitions of type 2 (stateset to ranking) and the according ranking-states
-	auto temp = add_type2_trans_ps(PS, nba);
+	auto temp = add_type2_trans_ps(PS, nba, mat, pred);
 
 	// Add transitions between rankings and the according states
-	auto Acomp = add_type3_trans(temp, nba);
+	auto Acomp = add_type3_trans(temp, nba, mat, pred);
 
 	// Add acceptance-property to states (final or non-final)
 	add_acceptance(&Acomp);
@@ -13,6 +13,7 @@
 
 // C++ Standard Library
 #include <bitset>
+#include <cstdint>
 #include <map>
 #include <vector>
 
@@ -100,35 +101,83 @@ vector<state_t> get_unreachable_states(auto const& aut){	// Currently not used
 
 
 /**
-*	\brief Determines recursively whether a certain SCC is a last SCC with a certain property.
+*	\brief	SCC-structure of an STS together with the reachability between its SCCs.
 *
-*	\param sts	The automaton, of which the SCC-structure is taken.
-*	\param vec	A vector that contains all SCCs from sts that fulfill a certain property. In the context of Buechi-complementation, this vector contains all SCCs that contain at least one state with a certain stateSet.
-*	\param scc	The SCC, for which it should be determined whether another SCC in vec is reachable from it. This scc should appear in in the vector vec.
-*	\param sccDat	SCC-data of sts.
-*
-*	\return	True, if no other SCC in vec is reachable from the given scc False otherwise.
+*	The SCCs are computed once, the reachability relation is stored as one bitset (in 64-bit words) per SCC,
+*	so that all "last SCCs" of all stateSets can be determined without walking the STS again.
 */
-bool is_last_scc(ComplAut const& sts, vector<unsigned> vec, unsigned scc, SCCDat sccDat){
-	auto succ = succ_sccs(aut_succ(sts), sccDat,scc);
-
-	// Check direct successor-SCCs
-	for(unsigned i = 0; i < vec.size(); i++){
-		if(find(succ.begin(), succ.end(), vec[i]) != succ.end()){
-			return false;
+struct STSSccs{
+	SCCDat sccDat;										///< SCC-Data of the STS
+	vector<vector<uint64_t>> reach;						///< For each SCC: all other SCCs that are reachable from it
+	map<bitset<max_nba_states>, vector<unsigned>, BitsetComp> sccsOf;	///< Key: stateSet, Value: SCCs containing a state with this stateSet, in order of first appearance
+
+	/**
+	*	\brief	Computes the SCCs of sts, their reachability and the SCCs of each stateSet.
+	*
+	*	\param sts	The ComplTag-automaton from which the SCC-structure is taken.
+	*/
+	STSSccs(ComplAut const& sts) : sccDat(get_sccs(sts.states(), aut_succ(sts), true)) {
+		unsigned const n = sccDat.sccs.size();
+		size_t const words = (n + 63) / 64;
+		reach.assign(n, vector<uint64_t>(words, 0));
+
+		// Successor-SCCs are completed (and numbered) before their predecessors,
+		// so their reachability is already known when an SCC is processed
+		for(unsigned scc = 0; scc < n; scc++){
+			auto& row = reach[scc];
+			for(auto const st : sccDat.sccs.at(scc)){
+				for(auto const suc : sts.succ(st)){
+					unsigned const sucSCC = sccDat.scc_of.at(suc);
+					if(sucSCC == scc || (row[sucSCC / 64] >> (sucSCC % 64)) & 1){continue;}
+					assert(sucSCC < scc);
+					row[sucSCC / 64] |= uint64_t(1) << (sucSCC % 64);
+					for(size_t w = 0; w < words; w++){
+						row[w] |= reach[sucSCC][w];
+					}
+				}
+			}
 		}
-	}
 
-	// Recursively check further away SCCs
-	bool res = true;
-	for(auto const& i : succ){
-		res = res && is_last_scc(sts, vec, i, sccDat);
+		// Collect the SCCs of each stateSet
+		for(auto const st : sts.states()){
+			auto& vec = sccsOf[sts.tag.geti(st).get_state_set()];
+			unsigned const scc = sccDat.scc_of.at(st);
+			if(find(vec.begin(), vec.end(), scc) == vec.end()){
+				vec.push_back(scc);
+			}
+		}
 	}
 
-	return res;
-}
-
+	/**
+	*	\brief	Returns a vector of "last SCCs" for a given stateSet.
+	*
+	*	\param stateSet	The stateSet, for which the last SCCs (in which it appears) should be determined.
+	*
+	*	\return	All SCCs containing the stateSet such that from these SCCs no other SCC containing the stateSet is reachable.
+	*/
+	vector<unsigned> last_sccs(bitset<max_nba_states> const& stateSet) const{
+		vector<unsigned> res;
+		auto const it = sccsOf.find(stateSet);
+		if(it == sccsOf.end()){return res;}
+
+		// Bitset of all SCCs containing the stateSet
+		vector<uint64_t> members(reach.empty() ? 0 : reach[0].size(), 0);
+		for(auto const scc : it->second){
+			members[scc / 64] |= uint64_t(1) << (scc % 64);
+		}
 
+		for(auto const scc : it->second){
+			bool last = true;
+			for(size_t w = 0; w < members.size() && last; w++){
+				last = !(reach[scc][w] & members[w]);
+			}
+			if(last){
+				res.push_back(scc);
+			}
+		}
+		return res;
+	}
+};
 
 
 
@@ -136,73 +185,39 @@ bool is_last_scc(ComplAut const& sts, vector<unsigned> vec, unsigned scc, SCCDat
 /**
 *	\brief	Returns a vector of "last SCCs" for a given stateSet.
 *
+*	If the last SCCs of more than one stateSet are needed, STSSccs should be used directly.
+*
 *	\param sts		The ComplTag-automaton from which the SCC-structure is taken.
 *	\param stateSet	The stateSet, for which the last SCCs (in which it appears) should be determined.
 *
 *	\return	A vector of all SCCs from the automaton sts such that from these SCCs no other SCC containing a state with the given stateSet is reachable.
 */
-vector<unsigned> last_sccs_for_stateset(ComplAut const& sts, bitset<max_nba_states> stateSet){
-
-	vector<unsigned> vec;		// Will constain all SCCs in which a slice with the given stateSet appears
-	vector<unsigned> res;		// Will contain all "last SCCs" in which a slice with the given stateSet appears
-
-	SCCDat sccDat = get_sccs(sts.states(), aut_succ(sts), true);
-
-	// Fill vec
-	for(auto st : sts.states()){
-		unsigned temp = sccDat.scc_of[st];
-		if(sts.tag.geti(st).stateSet == stateSet && find(vec.begin(), vec.end(), temp) == vec.end()){
-			vec.push_back(temp);
-		}
-	}
-
-	// Fill res
-	for(unsigned scc = 0; scc < vec.size(); scc++){
-		if(is_last_scc(sts, vec, vec[scc], sccDat)){
-			res.push_back(vec[scc]);
-		}
-	}
-
-	return res;
+inline vector<unsigned> last_sccs_for_stateset(ComplAut const& sts, bitset<max_nba_states> stateSet){
+	return STSSccs(sts).last_sccs(stateSet);
 }
 
 
 
 
 /**
-*	\brief	Copies ps and adds adds type-2 transitions for construction 3.
+*	\brief	Chooses one "last SCC" in the STS for each stateSet appearing in it.
 *
-*	This method adds transitions from powerset-states to ranking-states, with the
-*	optimization presented in "Optimization for the Complementation of Buechi Automata".
-*
-*	\param ps	The powerset-ComplTag-automaton of nba.
-*	\param nba	An automaton. In the context of Buechi-complementation, this is the input-automaton.
-*	\param heuristic	Determines which heuristic should be used to choose a last SCC in the STS of nba for each state-set appearing in ps.
-*					0: The last SCC with the smallest number assigned to it in the SCC-Data of the STS. This heuristic is the fastest.
-*					1: The last SCC consisting of the least amount of states. If this last SCC is not unique, the one with the smallest number assigned to it by the SCC-Data is chosen.
-*					2: The last SCC containing the least amount of states with the focused stateSet is chosen.
-*					else:	Randomly chosen
+*	\param sts		The STS of the input-automaton.
+*	\param stsSccs	The SCC-structure of sts.
+*	\param heuristic	Determines which heuristic should be used to choose a last SCC for each stateSet, see add_type2_trans_opt().
 *
-*	\return	A ComplTag-automaton consisting of the powerset-automaton and type-2 transitions (via construction 3).
+*	\return	Key: stateSet, Value: The chosen last SCC of the stateSet in stsSccs.
 */
-ComplAut add_type2_trans_opt(ComplAut const& ps, auto const& nba, unsigned short heuristic){
-
-	ComplAut res = ps;
+inline map<bitset<max_nba_states>, unsigned, BitsetComp> choose_last_sccs(ComplAut const& sts, STSSccs const& stsSccs, unsigned short heuristic){
 
-	ComplAut sts = sts_construction(nba, get_adjmat(nba));
-	SCCDat sccDat = get_sccs(sts.states(), aut_succ(sts), true);		// SCC-Data for sts
+	SCCDat const& sccDat = stsSccs.sccDat;
 
 	map<bitset<max_nba_states>, vector<unsigned>, BitsetComp> lastSCCs;	// Key: stateSet, Value: All SCCs in the STS that are a last SCC for the stateSet
 	map<bitset<max_nba_states>, unsigned, BitsetComp> chosenLastSCC;	// Key: stateSet, Value: One "last SCC" that is chosen from the vector of "last SCCs"
 
 	// Fill lastSCCs
-	for(auto st : sts.states()){
-
-		auto b = sts.tag.geti(st).stateSet;
-
-		if(lastSCCs.find(b) == lastSCCs.end()){	// Check if this stateSet has not been added as a key yet
-			lastSCCs[b] = last_sccs_for_stateset(sts, b);
-		}
+	for(auto const& k : stsSccs.sccsOf){
+		lastSCCs[k.first] = stsSccs.last_sccs(k.first);
 	}
 
 	// Fill chosenLastSCC by choosing one "last SCC" from the vector of each stateSet
@@ -219,7 +234,7 @@ ComplAut add_type2_trans_opt(ComplAut const& ps, auto const& nba, unsigned short
 			auto sccVec = k.second;
 			int smallestSCC = -1;
 			for(auto i : sccVec){
-				if(smallestSCC == -1 || sccDat.sccs[i].size() < sccDat.sccs[smallestSCC].size()){
+				if(smallestSCC == -1 || sccDat.sccs.at(i).size() < sccDat.sccs.at(smallestSCC).size()){
 					smallestSCC = i;
 				}
 			}
@@ -232,8 +247,8 @@ ComplAut add_type2_trans_opt(ComplAut const& ps, auto const& nba, unsigned short
 			int curStateSetCount = 0;
 			int smallestStateSetCount = -1;
 			for(auto i : sccVec){
-				for(auto j : sccDat.sccs[i]){
-					if(k.first == sts.tag.geti(j).stateSet){
+				for(auto j : sccDat.sccs.at(i)){
+					if(k.first == sts.tag.geti(j).get_state_set()){
 						curStateSetCount++;
 					}
 				}
@@ -253,6 +268,40 @@ ComplAut add_type2_trans_opt(ComplAut const& ps, auto const& nba, unsigned short
 		}
 	}
 
+	return chosenLastSCC;
+}
+
+
+
+
+/**
+*	\brief	Copies ps and adds adds type-2 transitions for construction 3.
+*
+*	This method adds transitions from powerset-states to ranking-states, with the
+*	optimization presented in "Optimization for the Complementation of Buechi Automata".
+*
+*	\param ps	The powerset-ComplTag-automaton of nba.
+*	\param nba	An automaton. In the context of Buechi-complementation, this is the input-automaton.
+*	\param mat	Adjacency-matrix of nba.
+*	\param pred	Reverse adjacency-matrix of nba.
+*	\param heuristic	Determines which heuristic should be used to choose a last SCC in the STS of nba for each state-set appearing in ps.
+*					0: The last SCC with the smallest number assigned to it in the SCC-Data of the STS. This heuristic is the fastest.
+*					1: The last SCC consisting of the least amount of states. If this last SCC is not unique, the one with the smallest number assigned to it by the SCC-Data is chosen.
+*					2: The last SCC containing the least amount of states with the focused stateSet is chosen.
+*					else:	Randomly chosen
+*
+*	\return	A ComplTag-automaton consisting of the powerset-automaton and type-2 transitions (via construction 3).
+*/
+ComplAut add_type2_trans_opt(ComplAut const& ps, auto const& nba, adj_mat const& mat, adj_mat const& pred, unsigned short heuristic){
+
+	ComplAut res = ps;
+
+	ComplAut sts = sts_construction(nba, mat, pred);
+	STSSccs const stsSccs(sts);								// SCCs of sts and their reachability, computed once
+	SCCDat const& sccDat = stsSccs.sccDat;
+
+	map<bitset<max_nba_states>, unsigned, BitsetComp> chosenLastSCC = choose_last_sccs(sts, stsSccs, heuristic);
+
 
 
 	// Add type-2-transitions and according states
@@ -262,38 +311,25 @@ ComplAut add_type2_trans_opt(ComplAut const& ps, auto const& nba, unsigned short
 
 			for(auto suc : ps.succ(st, x)){	// Contains only one element, since ps should be deterministic
 
-				unsigned tempSCC = chosenLastSCC[ps.tag.geti(suc).stateSet];
-				vector<unsigned> sucVec = sccDat.sccs[tempSCC];		// Contains all slice-states in the STS that are in the chosen "last SCC"
+				unsigned tempSCC = chosenLastSCC[ps.tag.geti(suc).get_state_set()];
+				auto const& sucVec = sccDat.sccs.at(tempSCC);		// Contains all slice-states in the STS that are in the chosen "last SCC"
 
 				for(auto const& s : sucVec){
 
-					if(sts.tag.geti(s).stateSet != ps.tag.geti(suc).stateSet){continue;}	// Skip slices with a different stateSet than the x-successor in ps
+					if(sts.tag.geti(s).get_state_set() != ps.tag.geti(suc).get_state_set()){continue;}	// Skip slices with a different stateSet than the x-successor in ps
 
-					vector<signed long> ranking = slice_to_rank(nba, sts.tag.geti(s).slice);
-
-					bool tagKnown = false;
-					unsigned long tagFoundAt;
+					// Ranking-tag for the slice (the stateSet is determined by the ranking)
+					ComplTag const tag = slice_tag_to_ranking(nba, sts.tag.geti(s));
 
 					// Check if the ranking is already known
-					for(auto j : res.states()){
-						if(res.tag.geti(j).stateType == 'r' && res.tag.geti(j).ranking == ranking){
-							tagKnown = true;
-							tagFoundAt = j;
-							break;
-						}
-					}
+					bool const tagKnown = res.tag.has(tag);
 
 					if(tagKnown){		// Tag is known, only add edge
+						unsigned long const tagFoundAt = res.tag.get(tag);
                       if (!res.has_edge(st,x,tagFoundAt))
 						res.add_edge(st, x, tagFoundAt);
 					}
 					else{				// Tag is unknown, add new state, edge and tag
-						ComplTag tag;
-						tag.stateType = 'r';
-						tag.stateSet = ps.tag.geti(suc).stateSet;
-						tag.ranking = ranking;
-						tag.obligationSet = 0;
-
 						res.add_state(res.num_states());
 						res.add_edge(st, x, res.num_states()-1);
 						res.tag.put(tag, res.num_states()-1);
@@ -320,17 +356,19 @@ ComplAut add_type2_trans_opt(ComplAut const& ps, auto const& nba, unsigned short
 *
 *	\param comp	A ComplTag-automaton that consists of type-1 and type-2 transitions of construction 3.
 *	\param nba	An automaton. In the context of Buechi-complementation, this is the input-automaton.
+*	\param mat	Adjacency-matrix of nba.
+*	\param pred	Reverse adjacency-matrix of nba.
 *
 *	\return	A ComplTag automaton consisting of the automaton given via comp, with type-3 transitions and according state.
 */
-ComplAut add_type3_trans_opt(ComplAut const& comp, auto const& nba){
+ComplAut add_type3_trans_opt(ComplAut const& comp, auto const& nba, adj_mat const& mat, adj_mat const& pred){
 
 
 	ComplAut res = comp;
 
 	//// OPT ///////////////////////////////////////////////////////////////////////
 	// Construct the powerset-automaton for nba, and get the according SCC-data
-	auto ps = compl_ps_construction(nba, get_adjmat(nba));
+	auto ps = compl_ps_construction(nba, mat);
 	SCCDat psSCC = get_sccs(ps.states(), aut_succ(ps), true);
 
 	// Key: a ComplTag-stateSet; Value: the SCC of this stateSet in the powerset-automaton
@@ -338,37 +376,30 @@ ComplAut add_type3_trans_opt(ComplAut const& comp, auto const& nba){
 
 	// Fill scc_of_stateset
 	for(auto p: ps.states()){
-		scc_of_stateset[ps.tag.geti(p).stateSet] = psSCC.scc_of[p];
+		scc_of_stateset[ps.tag.geti(p).get_state_set()] = psSCC.scc_of[p];
 	}
 	////////////////////////////////////////////////////////////////////////////////
 
 	bfs(res.get_init(), [&](auto const& st, auto const& visit, auto const&) {
 		if(st == comp.get_init()){for(auto& i : comp.states()){visit(i);}}		// Add all existing states to visit
 
-		if(res.tag.geti(st).stateType != 'r'){return;}		// Only ranking-states are of interest
+		if(res.tag.geti(st).get_state_type() != 'r'){return;}		// Only ranking-states are of interest
 
 		// Generate the x-successor of state st for each x in the alphabet
 		for(auto const x : res.syms()){
 
-			auto succ_tag = succ_ranking(nba, res.tag.geti(st), x);		// Get tag for x-successor of st
+			auto succ_tag = succ_ranking(nba, mat, pred, res.tag.geti(st), x);		// Get tag for x-successor of st
 
 			///// OPTIMIZATION /////////////////////////////////////////////////////////////////////
-			if(scc_of_stateset[res.tag.geti(st).stateSet] != scc_of_stateset[succ_tag.stateSet]){continue;}	// OPT
+			if(scc_of_stateset[res.tag.geti(st).get_state_set()] != scc_of_stateset[succ_tag.get_state_set()]){continue;}	// OPT
 			////////////////////////////////////////////////////////////////////////////////////////
 
 			// Check if succ_tag does already exist
-			bool tagKnown = false;
-			unsigned long tagFoundAt;
-			for(auto& i : res.states()){
-				if(res.tag.geti(i).ranking == succ_tag.ranking && res.tag.geti(i).obligationSet == succ_tag.obligationSet){
-					tagKnown = true;
-					tagFoundAt = i;
-					break;
-				}
-			}
+			bool const tagKnown = res.tag.has(succ_tag);
 
 			// Modify output-automaton
 			if(tagKnown){			// Ranking is already known, only add edge
+				unsigned long const tagFoundAt = res.tag.get(succ_tag);
               if (!res.has_edge(st,x,tagFoundAt)) {
 				res.add_edge(st, x, tagFoundAt);
 				visit(tagFoundAt);
@@ -405,14 +436,17 @@ ComplAut add_type3_trans_opt(ComplAut const& comp, auto const& nba){
 ComplAut compl_construction_opt(auto const& nba, adj_mat const& mat){
 	assert(nba.is_buchi());
 
+	// Predecessors are needed in both stages, compute them once
+	auto const pred = get_predmat(mat);
+
 	// Create the Powerset-automaton for the given input-automaton nba
 	auto PS = compl_ps_construction(nba, mat);
 
 	// Create automaton from PS that contains transitions of type 2 (stateset to ranking) and the according ranking-states
-	auto temp = add_type2_trans_opt(PS, nba, 1);
+	auto temp = add_type2_trans_opt(PS, nba, mat, pred, 1);
 
 	// Add transitions between rankings and the according states
-	auto Acomp = add_type3_trans_opt(temp, nba);
+	auto Acomp = add_type3_trans_opt(temp, nba, mat, pred);
 
 	// Add acceptance-property to states (final or non-final)
 	add_acceptance(&Acomp);
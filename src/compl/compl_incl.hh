@@ -0,0 +1,216 @@
+/**
+*	\file compl_incl.hh
+*
+*	This file contains the language inclusion check @f$ L(A) \subseteq L(B) @f$ for Büchi automata.
+*	It searches an accepting lasso in the product of A with the complementary automaton of B, which is
+*	generated on demand (see ComplSuccGen in compl_otf.hh): only the states of the complementary
+*	automaton that are reached by the product are constructed, and the search stops at the first accepting lasso.
+*	The top-level method is nba_inclusion().
+*/
+
+#pragma once
+
+// C++ Standard Library
+#include <cstdint>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// nbautils
+#include "aut.hh"
+
+// Compl
+#include "compl/compl_otf.hh"
+#include "compl/compl_tag.hh"
+
+
+namespace cmpl{
+
+using namespace std;
+using namespace nbautils;
+using namespace cmpl;
+
+using ComplAut = Aut<ComplTag>;
+
+
+/**
+*	\brief	Result of nba_inclusion().
+*/
+struct InclResult{
+	bool included = true;	///< True, if the language of A is included in the language of B
+	vector<sym_t> stem;		///< If not included: the word stem.loop^omega is accepted by A, but not by B
+	vector<sym_t> loop;
+	size_t prodStates = 0;	///< Number of explored states of the product
+	size_t complStates = 0;	///< Number of constructed states of the complementary automaton of B
+};
+
+
+
+
+/**
+*	\brief	Complementary automaton whose states are only expanded when their successors are requested.
+*
+*	The generator keeps references to nba and mat, which must outlive it.
+*/
+template <typename NBA>
+class ComplOnDemand{
+public:
+	ComplOnDemand(NBA const& nba, adj_mat const& mat, ComplConstr constr) : gen(nba, mat, constr), aut(gen.empty_aut()){}
+
+	state_t init() const{ return aut.get_init(); }
+	bool is_final(state_t c) const{ return aut.get_pri(c) == 0; }
+
+	/// The x-successors of c (expands c, if this has not happened yet)
+	vector<state_t> succ(state_t c, sym_t x){
+		if(c >= expanded.size() || !expanded[c]){
+			vector<state_t> added;
+			gen.add_successors(aut, c, gen.successors(aut.tag.geti(c)), added);
+			expanded.resize(aut.num_states(), false);
+			expanded[c] = true;
+		}
+		auto const sucs = aut.succ(c, x);
+		return vector<state_t>(sucs.begin(), sucs.end());
+	}
+
+	/// The part of the complementary automaton that has been constructed so far
+	ComplAut const& get_aut() const{ return aut; }
+
+private:
+	ComplSuccGen<NBA> const gen;
+	ComplAut aut;
+	vector<bool> expanded;
+};
+
+
+
+
+/**
+*	\brief	Checks whether the language of a is included in the language of b.
+*
+*	The emptiness of the product of a with the complementary automaton of b is checked by a nested depth-first search.
+*	The product is degeneralized by a flag that switches from 0 to 1 at accepting states of a and back from 1 to 0
+*	at final states of the complement, the latter are the accepting states of the product.
+*
+*	\param a	A state-based Büchi automaton.
+*	\param b	A state-based Büchi automaton over the same atomic propositions, with a priority for each state (see make_colored() in aut.hh).
+*	\param constr	The construction that is used for the complementary automaton of b.
+*
+*	\return	Whether the language of a is included in the language of b, a counterexample otherwise, and statistics.
+*
+*	\throws runtime_error	If a or b is not a state-based Büchi automaton, or b has too many states or letters.
+*/
+template <typename A, typename B>
+InclResult nba_inclusion(Aut<A> const& a, Aut<B> const& b, ComplConstr constr=ComplConstr::ps_opt){
+	assert(a.get_aps() == b.get_aps());
+	if(!a.is_buchi() || !b.is_buchi()){
+		throw runtime_error("Language inclusion is only checked for state-based Büchi automata!");
+	}
+	if(b.states().size() > max_nba_states || b.syms().size() > max_nba_syms){
+		throw runtime_error("The automaton is too large for complementation!");
+	}
+
+	auto const mat = get_adjmat(b);
+	ComplOnDemand<Aut<B>> comp(b, mat, constr);
+
+	// Product states (state of a, state of the complement, flag), numbered in the order of discovery
+	struct ProdState{ state_t a; state_t c; bool k; };
+	vector<ProdState> prod;
+	unordered_map<uint64_t, state_t> ids[2];		// Index of a product state for each value of the flag
+	auto const getId = [&](state_t pa, state_t pc, bool k){
+		uint64_t const key = (uint64_t(pc) << 32) | pa;
+		auto const it = ids[k].find(key);
+		if(it != ids[k].end()){ return it->second; }
+		state_t const id = prod.size();
+		prod.push_back(ProdState{pa, pc, k});
+		ids[k][key] = id;
+		return id;
+	};
+
+	auto const accepting = [&](state_t p){ return prod[p].k && comp.is_final(prod[p].c); };
+
+	// Successors of a product state, labelled with their letter
+	auto const successors = [&](state_t p){
+		vector<pair<sym_t, state_t>> sucs;
+		ProdState const cur = prod[p];
+		bool const k = cur.k ? !comp.is_final(cur.c) : a.state_buchi_accepting(cur.a);
+		for(auto const x : a.state_outsyms(cur.a)){
+			auto const csucs = comp.succ(cur.c, x);
+			for(auto const sa : a.succ(cur.a, x)){
+				for(auto const sc : csucs){
+					sucs.emplace_back(x, getId(sa, sc, k));
+				}
+			}
+		}
+		return sucs;
+	};
+
+	// Frame of an iterative depth-first search
+	struct Frame{
+		state_t st;
+		sym_t via;		// Letter of the edge to this state
+		vector<pair<sym_t, state_t>> sucs;
+		size_t next;
+	};
+
+	// Inner search: is there a cycle from seed back to seed? The letters of the cycle are stored in loop
+	vector<bool> red;
+	auto const cycle = [&](state_t seed, vector<sym_t>& loop){
+		vector<Frame> stack;
+		stack.push_back(Frame{seed, 0, successors(seed), 0});
+		while(!stack.empty()){
+			Frame& top = stack.back();
+			if(top.next == top.sucs.size()){
+				stack.pop_back();
+				continue;
+			}
+			auto const suc = top.sucs[top.next++];
+			if(suc.second == seed){		// Found the cycle
+				for(size_t i = 1; i < stack.size(); i++){ loop.push_back(stack[i].via); }
+				loop.push_back(suc.first);
+				return true;
+			}
+			red.resize(prod.size(), false);
+			if(!red[suc.second]){
+				red[suc.second] = true;
+				stack.push_back(Frame{suc.second, suc.first, successors(suc.second), 0});
+			}
+		}
+		return false;
+	};
+
+	// Outer search, accepting states are checked for a cycle in postorder
+	InclResult res;
+	vector<bool> blue;
+	vector<Frame> stack;
+	state_t const init = getId(a.get_init(), comp.init(), false);
+	blue.resize(prod.size(), false);
+	blue[init] = true;
+	stack.push_back(Frame{init, 0, successors(init), 0});
+	while(!stack.empty()){
+		Frame& top = stack.back();
+		if(top.next < top.sucs.size()){
+			auto const suc = top.sucs[top.next++];
+			blue.resize(prod.size(), false);
+			if(!blue[suc.second]){
+				blue[suc.second] = true;
+				stack.push_back(Frame{suc.second, suc.first, successors(suc.second), 0});
+			}
+			continue;
+		}
+
+		if(accepting(top.st) && cycle(top.st, res.loop)){	// Found an accepting lasso
+			res.included = false;
+			for(size_t i = 1; i < stack.size(); i++){ res.stem.push_back(stack[i].via); }
+			break;
+		}
+		stack.pop_back();
+	}
+
+	res.prodStates = prod.size();
+	res.complStates = comp.get_aut().num_states();
+	return res;
+}
+
+
+}	// End of namespace cmpl
@@ -0,0 +1,342 @@
+/**
+*	\file compl_otf.hh
+*
+*	This file contains an on-the-fly explorer for the Constructions 1, 2 and 3.
+*	Instead of building the stages one after another and copying the automaton between them,
+*	powerset-, slice- and ranking-states are generated from a single worklist, starting in the
+*	initial state. Only the states reachable in the complementary automaton are created.
+*	The top-level method is compl_construction_otf().
+*/
+
+#pragma once
+
+// C++ Standard Library
+#include <atomic>
+#include <bitset>
+#include <map>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// nbautils
+#include "aut.hh"
+#include "common/scc.hh"
+
+// Compl
+#include "compl/compl_constr1.hh"
+#include "compl/compl_constr2.hh"
+#include "compl/compl_constr3.hh"
+#include "compl/compl_print.hh"
+#include "compl/compl_tag.hh"
+
+
+namespace cmpl{
+
+using namespace std;
+using namespace nbautils;
+using namespace cmpl;
+
+using ComplAut = Aut<ComplTag>;
+
+
+/**
+*	\brief	The complementation constructions that can be explored on-the-fly.
+*/
+enum class ComplConstr{
+	al,		///< Construction 1 (STS and rankings), see al_construction()
+	ps,		///< Construction 2 (powerset-automaton and rankings), see compl_construction()
+	ps_opt	///< Construction 3 (optimized construction 2), see compl_construction_opt()
+};
+
+
+
+
+/**
+*	\brief	Calls f(i) for all i < n, distributed over the given number of threads.
+*
+*	\param n	The number of calls.
+*	\param jobs	The number of threads. With less than two threads or few calls, everything is called in the current thread in ascending order.
+*	\param f	The function that is called. Calls may happen concurrently, so f must not modify shared data.
+*/
+template <typename F>
+void parallel_for(size_t n, unsigned jobs, F const& f){
+	size_t const minPerThread = 16;		// Starting threads does not pay off for less calls
+	if(jobs < 2 || n < 2*minPerThread){
+		for(size_t i = 0; i < n; i++){ f(i); }
+		return;
+	}
+
+	atomic<size_t> next(0);
+	vector<thread> workers;
+	for(unsigned t = 0; t < jobs && t < n; t++){
+		workers.emplace_back([&]{
+			for(size_t i = next++; i < n; i = next++){ f(i); }
+		});
+	}
+	for(auto& w : workers){ w.join(); }
+}
+
+
+
+
+/**
+*	\brief	Determines the ranking-states that are targets of type-2 transitions in Construction 2 or 3.
+*
+*	In both constructions, a powerset-state has type-2 transitions to rankings of slices with the same stateSet,
+*	Construction 2 uses all reachable slices, Construction 3 only those in the chosen last SCC of the STS.
+*
+*	\param nba	The input-automaton.
+*	\param mat	Adjacency-matrix of nba.
+*	\param pred	Reverse adjacency-matrix of nba.
+*	\param opt	True for Construction 3, false for Construction 2.
+*	\param heuristic	The heuristic for choosing a last SCC in Construction 3, see add_type2_trans_opt().
+*
+*	\return	Key: stateSet, Value: The ranking-tags that are targets of type-2 transitions into this stateSet.
+*/
+map<bitset<max_nba_states>, vector<ComplTag>, BitsetComp> type2_targets(auto const& nba, adj_mat const& mat, adj_mat const& pred, bool opt, unsigned short heuristic){
+	map<bitset<max_nba_states>, vector<ComplTag>, BitsetComp> res;
+
+	ComplAut const sts = sts_construction(nba, mat, pred);
+
+	auto const addRanking = [&](state_t s){
+		ComplTag const tag = slice_tag_to_ranking(nba, sts.tag.geti(s));
+
+		auto& vec = res[tag.get_state_set()];
+		if(find(vec.begin(), vec.end(), tag) == vec.end()){
+			vec.push_back(tag);
+		}
+	};
+
+	if(!opt){		// Construction 2: all slices
+		for(auto const s : sts.states()){
+			addRanking(s);
+		}
+	}
+	else{			// Construction 3: slices in the chosen last SCC
+		STSSccs const stsSccs(sts);
+		for(auto const& k : choose_last_sccs(sts, stsSccs, heuristic)){
+			for(auto const s : stsSccs.sccDat.sccs.at(k.second)){
+				if(sts.tag.geti(s).get_state_set() == k.first){
+					addRanking(s);
+				}
+			}
+		}
+	}
+
+	return res;
+}
+
+
+
+
+/**
+*	\brief	Generates the states of the complementary automaton of one of the Constructions 1, 2 and 3 on demand.
+*
+*	All data that is needed in addition to the tags of the states (e.g. the targets of type-2 transitions)
+*	is computed by the constructor. successors() does not modify the generator and can be called concurrently.
+*	The generator keeps references to nba and mat, which must outlive it.
+*/
+template <typename NBA>
+class ComplSuccGen{
+public:
+	/**
+	*	\param nba	Input-NBW that should be complemented.
+	*	\param mat	Adjacency-Matrix of the input-NBW
+	*	\param constr	The construction that should be used.
+	*	\param heuristic	The heuristic for choosing a last SCC in Construction 3, see add_type2_trans_opt().
+	*/
+	ComplSuccGen(NBA const& nba, adj_mat const& mat, ComplConstr constr, unsigned short heuristic=1)
+		: nba(nba), mat(mat), pred(get_predmat(mat)), constr(constr){
+		assert(nba.is_buchi());
+
+		// Targets of type-2 transitions (Constructions 2 and 3)
+		if(constr != ComplConstr::al){
+			type2 = type2_targets(nba, mat, pred, constr == ComplConstr::ps_opt, heuristic);
+		}
+
+		// SCCs of the stateSets in the powerset-automaton (Construction 3)
+		if(constr == ComplConstr::ps_opt){
+			auto const ps = compl_ps_construction(nba, mat);
+			SCCDat const psSCC = get_sccs(ps.states(), aut_succ(ps), true);
+			for(auto const p : ps.states()){
+				sccOfStateSet[ps.tag.geti(p).get_state_set()] = psSCC.scc_of.at(p);
+			}
+		}
+	}
+
+	/// Tag of the initial state: the initial slice (Construction 1) or the initial stateSet (Constructions 2 and 3)
+	ComplTag init_tag() const{
+		ComplTag initTag;
+		initTag.set_state_set(nba_bitset(0).set(nba.get_init()));
+		if(constr == ComplConstr::al){
+			initTag.set_state_type('s');
+			vector<signed long> initSlice;
+			for(auto i : nba.states()){
+				initSlice.push_back(i == nba.get_init() ? 0 : -1);
+			}
+			initTag.set_slice(initSlice);
+		}
+		else{
+			initTag.set_state_type('p');
+		}
+		return initTag;
+	}
+
+	/// Ranking-states with empty obligationSet are final, all other states are non-final (as in add_acceptance())
+	static bool is_final(ComplTag const& tag){
+		return tag.get_state_type() == 'r' && tag.get_obligation_set() == 0;
+	}
+
+	/// All successors of a state, labelled with their letter
+	vector<pair<sym_t, ComplTag>> successors(ComplTag const& cur) const{
+		vector<pair<sym_t, ComplTag>> sucs;
+
+		if(cur.get_state_type() == 's'){			// Type-1 transition in the STS and type-2 transition to the ranking of the successor
+			RankArr curSlice;
+			cur.get_slice(curSlice);
+			for(auto const x : nba.syms()){
+				ComplTag slice = succ_slice(nba, mat, pred, cur.get_state_set(), curSlice, x);
+				ComplTag ranking = slice_tag_to_ranking(nba, slice);
+
+				sucs.emplace_back(x, move(slice));
+				sucs.emplace_back(x, move(ranking));
+			}
+		}
+		else if(cur.get_state_type() == 'p'){		// Type-1 transition in the powerset-automaton and type-2 transitions
+			for(auto const x : nba.syms()){
+				ComplTag ps;
+				ps.set_state_type('p');
+				ps.set_state_set(powersucc(mat, cur.get_state_set(), x));
+
+				auto const it = type2.find(ps.get_state_set());
+				sucs.emplace_back(x, move(ps));
+				if(it != type2.end()){
+					for(auto const& ranking : it->second){
+						sucs.emplace_back(x, ranking);
+					}
+				}
+			}
+		}
+		else{								// Type-3 transitions between rankings
+			for(auto const x : nba.syms()){
+				auto ranking = succ_ranking(nba, mat, pred, cur, x);
+				if(constr == ComplConstr::ps_opt && sccOfStateSet.at(cur.get_state_set()) != sccOfStateSet.at(ranking.get_state_set())){continue;}
+				sucs.emplace_back(x, move(ranking));
+			}
+		}
+
+		return sucs;
+	}
+
+	/// Empty complementary automaton with only the initial state
+	ComplAut empty_aut() const{
+		state_t const myinit = 0;
+		auto res = ComplAut(true, nba.get_name(), nba.get_aps(), myinit);
+		res.tag_to_str = [](ostream& out, ComplTag const& t){
+			print_compl_tag(out, t);
+		};
+		res.tag.put(init_tag(), myinit);
+		res.set_pri(myinit, is_final(init_tag()) ? 0 : 1);
+
+		string name = res.get_name();
+		switch(constr){
+		case ComplConstr::al:		name += "_compl_1"; break;
+		case ComplConstr::ps:		name += "_compl_2"; break;
+		case ComplConstr::ps_opt:	name += "_compl_3"; break;
+		}
+		res.set_name(name);
+		return res;
+	}
+
+	/**
+	*	\brief	Adds the given successors of state st to the complementary automaton aut.
+	*
+	*	\param aut	The complementary automaton, see empty_aut().
+	*	\param st	The expanded state.
+	*	\param sucs	The successors of st, see successors().
+	*	\param added	New states are appended to this vector.
+	*/
+	static void add_successors(ComplAut& aut, state_t st, vector<pair<sym_t, ComplTag>> const& sucs, vector<state_t>& added){
+		for(auto const& suc : sucs){
+			state_t sucst;
+			if(aut.tag.has(suc.second)){
+				sucst = aut.tag.get(suc.second);
+			}
+			else{
+				sucst = aut.num_states();
+				aut.add_state(sucst);
+				aut.tag.put(suc.second, sucst);
+				aut.set_pri(sucst, is_final(suc.second) ? 0 : 1);
+				added.push_back(sucst);
+			}
+			if(!aut.has_edge(st, suc.first, sucst)){
+				aut.add_edge(st, suc.first, sucst);
+			}
+		}
+	}
+
+private:
+	NBA const& nba;
+	adj_mat const& mat;
+	adj_mat const pred;
+	ComplConstr const constr;
+
+	map<bitset<max_nba_states>, vector<ComplTag>, BitsetComp> type2;	///< Key: stateSet, Value: targets of type-2 transitions into it
+	map<bitset<max_nba_states>, unsigned, BitsetComp> sccOfStateSet;	///< Key: stateSet, Value: its SCC in the powerset-automaton
+};
+
+
+
+
+/////////// ON-THE-FLY COMPLEMENTATION ///////////////////////////////////////////////////////////////
+/**
+*	\brief	Constructs the complementary automaton of one of the Constructions 1, 2 and 3 on-the-fly.
+*
+*	The result has the same states (tags), transitions and acceptance as the automaton that is returned by
+*	al_construction(), compl_construction() or compl_construction_opt() respectively, but the states are
+*	numbered in the order of their discovery. No intermediate automaton is copied.
+*	The states of the worklist are expanded in blocks, the successors of a block are computed in parallel
+*	and then added in the order of the block, so the result does not depend on the number of threads.
+*
+*	\param nba	Input-NBW that should be complemented.
+*	\param mat	Adjacency-Matrix of the input-NBW
+*	\param constr	The construction that should be used.
+*	\param jobs	Number of threads that compute successors.
+*	\param heuristic	The heuristic for choosing a last SCC in Construction 3, see add_type2_trans_opt().
+*
+*	\return	The complementary NBW for the input-NBW nba.
+*/
+ComplAut compl_construction_otf(auto const& nba, adj_mat const& mat, ComplConstr constr, unsigned jobs=1, unsigned short heuristic=1){
+	size_t const blockSize = 4096;		// Maximal number of states whose successors are kept at once
+
+	ComplSuccGen<decay_t<decltype(nba)>> const gen(nba, mat, constr, heuristic);
+	auto res = gen.empty_aut();
+
+	// Explore level by level, in blocks of at most blockSize states
+	vector<state_t> frontier{res.get_init()};
+	vector<state_t> next;
+	vector<vector<pair<sym_t, ComplTag>>> sucs;
+	while(!frontier.empty()){
+		for(size_t from = 0; from < frontier.size(); from += blockSize){
+			size_t const num = min(blockSize, frontier.size() - from);
+
+			// Compute successors in parallel (the automaton is not modified meanwhile)
+			sucs.assign(num, {});
+			parallel_for(num, jobs, [&](size_t i){
+				sucs[i] = gen.successors(res.tag.geti(frontier[from + i]));
+			});
+
+			// Add them sequentially, in the order of the block
+			for(size_t i = 0; i < num; i++){
+				gen.add_successors(res, frontier[from + i], sucs[i], next);
+			}
+		}
+		frontier.swap(next);
+		next.clear();
+	}
+
+	return res;
+}
+
+
+}	// End of namespace cmpl
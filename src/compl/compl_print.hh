@@ -34,7 +34,7 @@ using namespace cmpl;
 *	\param bs	Pointer to the bitset of size max_nba_states that should be printed as a stateset.
 *	\param out 	The ostream, to which the result should be output. If not defined, cout is used.
 */
-void print_compl_bitset(const bitset<max_nba_states>* bs, ostream &out = cout){
+inline void print_compl_bitset(const bitset<max_nba_states>* bs, ostream &out = cout){
 	
 	bool first = true;		// is true until the first positions with 1-bit has been found
 	out << "{";
@@ -64,7 +64,7 @@ void print_compl_bitset(const bitset<max_nba_states>* bs, ostream &out = cout){
 *	\param vec	Pointer to a vector of signed longs that should be printed as a slice.
 *	\param out 	The ostream, to which the result should be output. If not defined, cout is used.
 */
-void print_compl_slice(const vector<signed long>* vec, ostream &out = cout){
+inline void print_compl_slice(const vector<signed long>* vec, ostream &out = cout){
 	
 	bool first = true;			// Remembers if there is an element in the currently checked equivalence class
 	bool firstEqClass = true;	// Remembers if there was an element that was not -1
@@ -123,7 +123,7 @@ void print_compl_slice(const vector<signed long>* vec, ostream &out = cout){
 *	\param vec	Pointer to a vector of signed longs that should be printed as a ranking.
 *	\param out 	The ostream, to which the result should be output. If not defined, cout is used.
 */
-void print_compl_ranking(const vector<signed long>* vec, ostream &out = cout){
+inline void print_compl_ranking(const vector<signed long>* vec, ostream &out = cout){
 	
 	bool first = true;		// is true until the first positions with 1-bit has been found
 	out << "";
@@ -152,26 +152,32 @@ void print_compl_ranking(const vector<signed long>* vec, ostream &out = cout){
 *	\param cout	The ostream, to which the result should be output.
 *	\param t	The ComplTag, that should be printed.
 */
-void print_compl_tag(ostream& cout, ComplTag const& t){
+inline void print_compl_tag(ostream& cout, ComplTag const& t){
 
-	char stateType = t.stateType;		// t is pointer, -> accesses member of pointer
+	char stateType = t.get_state_type();		// t is pointer, -> accesses member of pointer
 	
 	switch(stateType){
 		case 'p': 	// Return the set as state-name for a powerset-state
 					cout << "Stateset: ";
-					print_compl_bitset(&t.stateSet, cout);
+					print_compl_bitset(&t.get_state_set(), cout);
 					break;
 					
 		case 's': 	// Return the slice
 					cout << "Slice: ";
-					print_compl_slice(&t.slice, cout);
+					{
+						auto const slice = t.get_slice();
+						print_compl_slice(&slice, cout);
+					}
 					break;
 					
 		case 'r': 	// Return the ranking
 					cout << "Ranking: ";
-					print_compl_ranking(&t.ranking, cout);
+					{
+						auto const ranking = t.get_ranking();
+						print_compl_ranking(&ranking, cout);
+					}
 					cout << "	   Obligation-Set: ";
-					print_compl_bitset(&t.obligationSet, cout);
+					print_compl_bitset(&t.get_obligation_set(), cout);
 					break;
 					
 		default:	// Undefined case, return error
@@ -186,7 +192,7 @@ void print_compl_tag(ostream& cout, ComplTag const& t){
 *
 *	\param sccDat Pointer to the SCCDat that should be printed.
 */
-void print_SCC(SCCDat* sccDat){
+inline void print_SCC(SCCDat* sccDat){
 	cout << endl;
 	for(state_t i = 0; i < sccDat->sccs.size(); i++){	// For each SCC i
 		cout << "SCC " << i << ":   ";
@@ -204,7 +210,7 @@ void print_SCC(SCCDat* sccDat){
 *	\param vec	Pointer to the vector<signed long> that contains the elements that should be printed.
 *	\param out 	The ostream, to which the result should be output. If not defined, cout is used.
 */
-void print_vector(const vector<signed long>* vec, ostream &out = cout){
+inline void print_vector(const vector<signed long>* vec, ostream &out = cout){
 
 	for(size_t i = 0; i < vec->size(); i++){
 		out << vec->operator[](i) << " ";
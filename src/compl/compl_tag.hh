@@ -9,7 +9,10 @@
 #pragma once
 
 // C++ Standard Library
+#include <array>
 #include <bitset>
+#include <cstdint>
+#include <string>
 #include <vector>
 
 // nbautils
@@ -21,30 +24,167 @@ using namespace std;
 using namespace nbautils;
 using namespace cmpl;
 
+/**
+*	\brief	Slice- or ranking-vector with a fixed capacity, used by the in-place kernels in compl_constr1.hh.
+*
+*	Holds one value per state of the input-automaton (-1 for states that are not contained) and needs no heap memory.
+*/
+struct RankArr{
+	array<int16_t, max_nba_states> val;
+	unsigned len = 0;
+
+	RankArr(){};
+	explicit RankArr(unsigned n, signed long v=-1) : len(n){ fill(val.begin(), val.begin()+n, v); }
+
+	unsigned size() const{ return len; }
+	int16_t& operator[](unsigned i){ return val[i]; }
+	int16_t operator[](unsigned i) const{ return val[i]; }
+	int16_t const* begin() const{ return val.data(); }
+	int16_t const* end() const{ return val.data() + len; }
+
+	/// Largest value, -1 if no state is contained
+	signed long max_value() const{
+		signed long res = -1;
+		for(auto const v : *this){ if(v > res){ res = v; } }
+		return res;
+	}
+
+	vector<signed long> to_vector() const{ return vector<signed long>(begin(), end()); }
+	static RankArr from_vector(vector<signed long> const& vec){
+		RankArr res;
+		res.len = vec.size();
+		copy(vec.begin(), vec.end(), res.val.begin());
+		return res;
+	}
+};
+
+/**
+*	\brief	Compact encoding of a slice- or ranking-vector.
+*
+*	Each state takes one byte, which holds its value + 1 (thus 0 for states with value -1).
+*	Values from 254 on are escaped by the byte 255, followed by two bytes.
+*	As the encoding is unique, vectors can be compared on their encoded form.
+*	A string is used as byte container, so short vectors do not need any heap memory.
+*/
+class PackedVec{
+public:
+	PackedVec(){};
+
+	template <typename Vec>
+	explicit PackedVec(Vec const& vec){
+		bytes.reserve(vec.size());
+		for(auto const v : vec){
+			assert(v >= -1 && v < 0xffff);
+			unsigned long const u = v + 1;
+			if(u < 0xff){
+				bytes.push_back(static_cast<char>(u));
+			}
+			else{
+				bytes.push_back(static_cast<char>(0xff));
+				bytes.push_back(static_cast<char>(u & 0xff));
+				bytes.push_back(static_cast<char>(u >> 8));
+			}
+		}
+	}
+
+	vector<signed long> unpack() const{
+		RankArr arr;
+		unpack(arr);
+		return arr.to_vector();
+	}
+
+	void unpack(RankArr& arr) const{
+		arr.len = 0;
+		for(size_t i = 0; i < bytes.size(); i++){
+			unsigned long u = static_cast<unsigned char>(bytes[i]);
+			if(u == 0xff){
+				u = static_cast<unsigned char>(bytes[i+1]) | (static_cast<unsigned char>(bytes[i+2]) << 8);
+				i += 2;
+			}
+			arr.val[arr.len++] = static_cast<signed long>(u) - 1;
+		}
+	}
+
+	string const& data() const{ return bytes; }
+
+	bool operator==(const PackedVec &toComp) const{ return bytes == toComp.bytes; }
+	bool operator!=(const PackedVec &toComp) const{ return bytes != toComp.bytes; }
+
+private:
+	string bytes;
+};
+
 /**
 *	\brief	This class is used to represent tags for the states in the complementary Buechi-automaton.
+*
+*	Slice and ranking are stored as PackedVec and can only be accessed via get_slice() / set_slice()
+*	and get_ranking() / set_ranking(), the other members via their getters and setters as well.
+*	The hash of the whole tag is updated by the setters, so hashing a tag does not touch its data.
 */
 class ComplTag{
 public:
 	// Constructor
-	ComplTag(){};
+	ComplTag(){ rehash(); }
 
 	// Currently (17.09.2018): nbautils::max_nba_states = 256 in aut.hh
-	
-	// Data
-	char stateType;						/// Defines the type of the state. p: state on powerset-stage, r: ranking, s: slice	
-	bitset<max_nba_states> stateSet;	/// Represents a stateset of the input-automaton for complementation.
-	vector<signed long> slice;			/// Vector that represents a slice. For more information, see the documentation of print_compl_slice in compl_print.hh
-	vector<signed long> ranking;		/// Vector that represents a ranking. For more information, see the documentation of print_compl_ranking() in compl_print.hh
-	bitset<max_nba_states> obligationSet; /// Represents a stateset of the input-automaton, used as obligation-set.
-	
+
+	/// Defines the type of the state. p: state on powerset-stage, r: ranking, s: slice
+	char get_state_type() const{ return stateType; }
+	void set_state_type(char type){ stateType = type; rehash(); }
+
+	/// Represents a stateset of the input-automaton for complementation.
+	bitset<max_nba_states> const& get_state_set() const{ return stateSet; }
+	void set_state_set(bitset<max_nba_states> const& set){ stateSet = set; rehash(); }
+
+	/// Represents a stateset of the input-automaton, used as obligation-set.
+	bitset<max_nba_states> const& get_obligation_set() const{ return obligationSet; }
+	void set_obligation_set(bitset<max_nba_states> const& set){ obligationSet = set; rehash(); }
+
+	/// Vector that represents a slice. For more information, see the documentation of print_compl_slice in compl_print.hh
+	vector<signed long> get_slice() const{ return slice.unpack(); }
+	void get_slice(RankArr& arr) const{ slice.unpack(arr); }
+	void set_slice(vector<signed long> const& vec){ slice = PackedVec(vec); rehash(); }
+	void set_slice(RankArr const& arr){ slice = PackedVec(arr); rehash(); }
+	PackedVec const& packed_slice() const{ return slice; }
+
+	/// Vector that represents a ranking. For more information, see the documentation of print_compl_ranking() in compl_print.hh
+	vector<signed long> get_ranking() const{ return ranking.unpack(); }
+	void get_ranking(RankArr& arr) const{ ranking.unpack(arr); }
+	void set_ranking(vector<signed long> const& vec){ ranking = PackedVec(vec); rehash(); }
+	void set_ranking(RankArr const& arr){ ranking = PackedVec(arr); rehash(); }
+	PackedVec const& packed_ranking() const{ return ranking; }
+
+	/// Precomputed hash of the whole tag
+	size_t tag_hash() const{ return tagHash; }
+
 	// Comparator
 	bool operator==(const ComplTag &toComp) const{
-		return stateType == toComp.stateType
+		return tagHash == toComp.tagHash
+			&& stateType == toComp.stateType
 			&& stateSet == toComp.stateSet
+			&& obligationSet == toComp.obligationSet
 			&& slice == toComp.slice
-			&& ranking == toComp.ranking
-			&& obligationSet == toComp.obligationSet;
+			&& ranking == toComp.ranking;
+	}
+
+private:
+	char stateType = 0;
+	bitset<max_nba_states> stateSet;
+	bitset<max_nba_states> obligationSet;
+	PackedVec slice;
+	PackedVec ranking;
+	size_t tagHash = 0;
+
+	// Compute individual hash values for each member
+	// http://stackoverflow.com/a/1646913/126995
+	void rehash(){
+		size_t res = 17;
+		res = res * 31 + hash<char>()( stateType );
+		res = res * 31 + hash<bitset<max_nba_states>>()( stateSet );
+		res = res * 31 + hash<string>()( slice.data() );
+		res = res * 31 + hash<string>()( ranking.data() );
+		res = res * 31 + hash<bitset<max_nba_states>>()( obligationSet );
+		tagHash = res;
 	}
 };
 
@@ -54,34 +194,19 @@ public:
 namespace std{
 
 	using namespace cmpl;	// To find ComplTag
-	
+
 /**
 *	\brief Definition of a hash-function for objects of type ComplTag.
 *
-* 	Hash-function to hash ComplTag-objects such that they can be stored in 
+* 	Hash-function to hash ComplTag-objects such that they can be stored in
 * 	an unordered map (used for managing tags of automata).
 * 	It is constructed similar to the hash functions found in pa.hh.
 */
 	template <>
 	struct hash<ComplTag> {
 	  size_t operator()(ComplTag const& k) const {
-		// Compute individual hash values for each sub-type
-		// http://stackoverflow.com/a/1646913/126995
-		size_t res = 17;
-		res = res * 31 + hash<char>()( k.stateType );
-		res = res * 31 + hash<bitset<max_nba_states>>()( k.stateSet );
-		
-		for(auto i : k.slice){
-			res = res * 31 + (hash<signed long>() ( k.slice[i] ));
-		}
-		
-		for(auto i : k.ranking){
-			res = res * 31 + (hash<signed long>() ( k.ranking[i] ));
-		}
-		
-		res = res * 31 + hash<bitset<max_nba_states>>()( k.obligationSet );
-
-		return res;
+		// Computed by the setters of ComplTag
+		return k.tag_hash();
 	  }
 	};
-}	// End of namespace std
\ No newline at end of file
+}	// End of namespace std
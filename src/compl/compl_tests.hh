@@ -170,14 +170,14 @@ void automaton_test2(){
   
   
   ComplTag tag0;
-  tag0.stateType = 'p';
-  tag0.stateSet.set(0, 1);			// Set bit at position 0 to value 1
+  tag0.set_state_type('p');
+  tag0.set_state_set(bitset<max_nba_states>(1));	// Set bit at position 0 to value 1
   
   // Print out ComlTag, for which the address is put in tag
   cout << "\033[1;4;34m" 	<< "Initial ComplTag, for which the address is saved" << "\033[0m" << endl << endl;
-  cout << "StateType: " 	<<  	   tag0.stateType << endl << endl;
-  cout << "StateSet: " 		<< endl << tag0.stateSet << endl << endl;
-  cout << "ObligationSet: "	<< endl << tag0.obligationSet << endl << endl << endl;
+  cout << "StateType: " 	<<  	   tag0.get_state_type() << endl << endl;
+  cout << "StateSet: " 		<< endl << tag0.get_state_set() << endl << endl;
+  cout << "ObligationSet: "	<< endl << tag0.get_obligation_set() << endl << endl << endl;
   
   
   aut.tag.put(tag0, 0);		// Save address of tag0 as the tag of state 0
@@ -189,9 +189,9 @@ void automaton_test2(){
   
   // Print out ComlTag, for which the address was received from tag
   cout << "\033[1;4;34m" 	<< "ComplTag, for which the address was saved" << "\033[0m" << endl << endl;
-  cout << "StateType: " 	<< 		   returnedTag.stateType << endl << endl;
-  cout << "StateSet: " 		<< endl << returnedTag.stateSet << endl << endl;
-  cout << "ObligationSet: "	<< endl << returnedTag.obligationSet << endl << endl << endl;
+  cout << "StateType: " 	<< 		   returnedTag.get_state_type() << endl << endl;
+  cout << "StateSet: " 		<< endl << returnedTag.get_state_set() << endl << endl;
+  cout << "ObligationSet: "	<< endl << returnedTag.get_obligation_set() << endl << endl << endl;
   
   
   
@@ -255,13 +255,13 @@ void mod_ps_test(){
 	//////// TEMP TEST///////////////////////////////////////////////////////////////////////////
 	list<ComplTag>::iterator it;
 	for(it = tagList.begin(); it != tagList.end(); ++it){
-		cout << it->stateType << "      " << it->stateSet << endl;
+		cout << it->get_state_type() << "      " << it->get_state_set() << endl;
 	}
 	cout << endl << endl;
 	for(unsigned int i = 0; i < modPsAut.num_states(); i++){
 		cout << "yello" << endl;
-		cout << modPsAut.tag.geti(i)->stateType << endl;//<< "      " << aut.tag.geti(i).stateSet << endl;
-		print_compl_bitset(&modPsAut.tag.geti(i)->stateSet);
+		cout << modPsAut.tag.geti(i)->get_state_type() << endl;//<< "      " << aut.tag.geti(i).get_state_set() << endl;
+		print_compl_bitset(&modPsAut.tag.geti(i)->get_state_set());
 		cout << endl << endl;
 	}
 	////////////////////////////////////////////////////////////////////////////////////////////
@@ -482,17 +482,18 @@ void successor_ranking_test(){
 	obSet.set(2);
 	
 	ComplTag tag;
-	tag.ranking = ranking1;
-	tag.obligationSet = obSet;
+	tag.set_ranking(ranking1);
+	tag.set_obligation_set(obSet);
 	
 	auto sucTag = succ_ranking(aut, tag, 1);
 	
 	cout << "\033[1;34m" 	<< "Successor ranking test: " << "\033[0m" << endl << endl;
 	
 	cout << endl;
-	print_compl_ranking(&sucTag.ranking);
+	auto const sucRanking = sucTag.get_ranking();
+	print_compl_ranking(&sucRanking);
 	cout << endl;
-	print_compl_bitset(&sucTag.obligationSet);
+	print_compl_bitset(&sucTag.get_obligation_set());
 }
 
 
@@ -575,25 +576,25 @@ void last_scc_test(){
   ComplTag tag7;
   ComplTag tag8;
   
-  tag0.stateSet = 0;	//0
-  tag1.stateSet = 1;		//1
-  tag2.stateSet = 3;				//3
-  tag3.stateSet = 2;			//2
-  tag4.stateSet = 3;				//3
-  tag5.stateSet = 3;				//3
-  tag6.stateSet = 0;	//0
-  tag7.stateSet = 2;			//2
-  tag8.stateSet = 3;				//3
-  
-  tag0.stateType = 'p';
-  tag1.stateType = 'p';
-  tag2.stateType = 'p';
-  tag3.stateType = 'p';
-  tag4.stateType = 'p';
-  tag5.stateType = 'p';
-  tag6.stateType = 'p';
-  tag7.stateType = 'p';
-  tag8.stateType = 'p';
+  tag0.set_state_set(0);	//0
+  tag1.set_state_set(1);		//1
+  tag2.set_state_set(3);				//3
+  tag3.set_state_set(2);			//2
+  tag4.set_state_set(3);				//3
+  tag5.set_state_set(3);				//3
+  tag6.set_state_set(0);	//0
+  tag7.set_state_set(2);			//2
+  tag8.set_state_set(3);				//3
+  
+  tag0.set_state_type('p');
+  tag1.set_state_type('p');
+  tag2.set_state_type('p');
+  tag3.set_state_type('p');
+  tag4.set_state_type('p');
+  tag5.set_state_type('p');
+  tag6.set_state_type('p');
+  tag7.set_state_type('p');
+  tag8.set_state_type('p');
   
 	
   aut.tag.put(tag0, 0);
@@ -985,28 +986,30 @@ void rankTEST(){
 	auto aut = autstream.parse_next();
 	
 	ComplTag tag;
-	tag.stateType = 'r';
+	tag.set_state_type('r');
 	
-	tag.stateSet = 3;
+	tag.set_state_set(3);
 	
 	vector<signed long> ranking;
 	ranking.push_back(0);
 	ranking.push_back(1);
 	
-	tag.ranking = ranking;
-	tag.obligationSet = 0;
+	tag.set_ranking(ranking);
+	tag.set_obligation_set(0);
 	
 	
 	
 	auto aTrans = succ_ranking(aut, tag, 0);
 	auto bTrans = succ_ranking(aut, tag, 1);
 	
-	auto tight_aTrans = tighten_ranking(aut, &aTrans.ranking);
-	auto tight_bTrans = tighten_ranking(aut, &bTrans.ranking);
+	auto aRanking = aTrans.get_ranking();
+	auto bRanking = bTrans.get_ranking();
+	auto tight_aTrans = tighten_ranking(aut, &aRanking);
+	auto tight_bTrans = tighten_ranking(aut, &bRanking);
 	
-	print_compl_ranking(&aTrans.ranking);
+	print_compl_ranking(&aRanking);
 	cout << endl << endl;
-	print_compl_ranking(&bTrans.ranking);
+	print_compl_ranking(&bRanking);
 	cout << endl << endl;
 	print_compl_ranking(&tight_aTrans);
 	cout << endl << endl;
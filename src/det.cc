@@ -1,12 +1,120 @@
+#include <cstdio>
+
 #include "aut.hh"
 #include "det.hh"
+#include "checkpoint.hh"
 
 namespace nbautils {
   using namespace std;
 
+namespace {
+  string const checkpoint_magic = "nbadet-checkpoint 1";
+}
+
+void save_det_checkpoint(string const& file, string const& key, PA const& pa,
+    trie_map<nba_bitset, DetState> const& existing, unordered_set<state_t> const& expanded,
+    BFSState<DetBFSNode> const& bfsst, uint64_t numedges) {
+  PROF_PHASE("checkpoint");
+  string const tmpfile = file + ".tmp";
+  BinWriter out(tmpfile);
+  out.str(checkpoint_magic);
+  out.str(key);
+
+  //states with tags, then edges
+  out.u64(pa.num_states());
+  for (auto const p : pa.states()) {
+    out.u64(p);
+    out.detstate(pa.tag.geti(p));
+  }
+  uint64_t numedg = 0;
+  for (auto const p : pa.states())
+    for (auto const x : pa.state_outsyms(p))
+      numedg += pa.succ_edges(p, x).size();
+  out.u64(numedg);
+  for (auto const p : pa.states())
+    for (auto const x : pa.state_outsyms(p))
+      for (auto const& e : pa.succ_edges(p, x)) {
+        out.u64(p);
+        out.u64(x);
+        out.u64(e.first);
+        out.i64(e.second);
+      }
+
+  //exploration state
+  out.u64(expanded.size());
+  for (auto const s : expanded)
+    out.u64(s);
+  out.u64(bfsst.visited.size());
+  for (auto const& nod : bfsst.visited) {
+    out.bits(nod.first);
+    out.u64(nod.second);
+  }
+  out.u64(bfsst.queue.size());
+  for (auto const& nod : bfsst.queue) {
+    out.bits(nod.first);
+    out.u64(nod.second);
+  }
+  out.u64(numedges);
+
+  //trie in creation order
+  out.u64(existing.size());
+  existing.for_each_entry([&](tree_history const& th, DetState const& ds) {
+    out.u64(th.size());
+    for (auto const& b : th)
+      out.bits(b);
+    out.detstate(ds);
+  });
+  out.close();
+
+  if (rename(tmpfile.c_str(), file.c_str()) != 0)
+    throw runtime_error("cannot write checkpoint " + file + "!");
+}
+
+bool load_det_checkpoint(string const& file, string const& key, PA& pa,
+    trie_map<nba_bitset, DetState>& existing, unordered_set<state_t>& expanded,
+    BFSState<DetBFSNode>& bfsst, uint64_t& numedges) {
+  BinReader in(file);
+  if (!in.is_open())
+    return false;
+  if (in.str() != checkpoint_magic)
+    throw runtime_error("not a checkpoint file: " + file);
+  if (in.str() != key) //belongs to other input or options
+    return false;
+
+  for (uint64_t i = in.u64(); i > 0; i--) {
+    state_t const p = in.u64();
+    if (!pa.has_state(p))
+      pa.add_state(p);
+    pa.tag.put(in.detstate(), p);
+  }
+  for (uint64_t i = in.u64(); i > 0; i--) {
+    state_t const p = in.u64();
+    sym_t const x = in.u64();
+    state_t const q = in.u64();
+    pa.add_edge(p, x, q, in.i64());
+  }
 
-/*
+  for (uint64_t i = in.u64(); i > 0; i--)
+    expanded.emplace(in.u64());
+  for (uint64_t i = in.u64(); i > 0; i--) {
+    auto const b = in.bits();
+    DetBFSNode const nod(b, in.u64());
+    bfsst.visited.emplace(nod);
+    bfsst.discovered.emplace(nod);
+  }
+  for (uint64_t i = in.u64(); i > 0; i--) {
+    auto const b = in.bits();
+    bfsst.push(DetBFSNode(b, in.u64()));
+  }
+  numedges = in.u64();
 
-*/
+  for (uint64_t i = in.u64(); i > 0; i--) {
+    tree_history th(in.u64());
+    for (auto& b : th)
+      b = in.bits();
+    existing.put(th, in.detstate());
+  }
+  return true;
+}
 
 }  // namespace nbautils
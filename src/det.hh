@@ -1,6 +1,9 @@
 #pragma once
 
+#include <cstdio>
 #include <functional>
+#include <sstream>
+#include <iomanip>
 #include <queue>
 #include <set>
 #include <unordered_set>
@@ -11,13 +14,55 @@
 #include "common/types.hh"
 #include "common/trie_map.hh"
 #include "common/hitset.hh"
+#include "metrics/profiler.hh"
+#include "metrics/counters.hh"
+#include "metrics/memusage.h"
 // #include "common/maxsat.hh"
 #include "aut.hh"
+#include "io.hh"
+#include "statestore.hh"
 
 namespace nbautils {
 
 using PA = Aut<DetState>;
 
+// thrown when a determinization exceeds its resource limits,
+// carries the statistics of the explored part
+struct BudgetExceeded : public runtime_error {
+  string resource; //states, memory or time
+  size_t states;
+  size_t edges;
+  double secs;
+  size_t rss;
+
+  BudgetExceeded(string const& res, size_t numstates, size_t numedges, double s, size_t mem)
+    : runtime_error(message(res, numstates, numedges, s, mem)),
+      resource(res), states(numstates), edges(numedges), secs(s), rss(mem) {}
+
+  static string message(string const& res, size_t numstates, size_t numedges, double s, size_t mem) {
+    stringstream ss;
+    ss << res << " budget exceeded after " << numstates << " states, " << numedges << " edges, "
+       << fixed << setprecision(3) << s << " s, " << mem / (1024.0 * 1024.0) << " MB";
+    return ss.str();
+  }
+};
+
+// throws if the exploration of a DPA with given size violates the limits in dc.
+// time and memory are more expensive to query, so only every 256th call checks them
+inline void check_budget(DetConf const& dc, size_t states, size_t edges, size_t& calls, timepoint_t start) {
+  if (dc.max_states && states > dc.max_states)
+    throw BudgetExceeded("state", states, edges, get_secs_since(start), getCurrentRSS());
+  if ((++calls & 255) != 0)
+    return;
+  if (dc.has_deadline && get_time() > dc.deadline)
+    throw BudgetExceeded("time", states, edges, get_secs_since(start), getCurrentRSS());
+  if (dc.max_memory) {
+    size_t const rss = getCurrentRSS();
+    if (rss > dc.max_memory)
+      throw BudgetExceeded("memory", states, edges, get_secs_since(start), rss);
+  }
+}
+
 // takes: reference successor, mask for restricting candidates, valid pointer to sub-trie node,
 // prefix up to sub-trie node, the prefix length and current depth
 // returns: suitable candidate(s)
@@ -46,14 +91,17 @@ vector<DetState*> trie_dfs(DetState const& ref, auto const &msk,
   if (nodptr->value && (msk.second.back() & ~pref) == 0) {
     DetState* cand = nodptr->value.get();
 
-    if (cand && ref.tuples_finer_or_equal(*cand))
+    COUNT(trie_tried);
+    if (cand && ref.tuples_finer_or_equal(*cand)) {
+      COUNT(trie_accepted);
       ret.push_back(cand);
+    }
   }
 
   return ret;
 }
 
-vector<DetState*> existing_succ(DetConf const& dc, trie_map<nba_bitset, DetState>& existing,
+inline vector<DetState*> existing_succ(DetConf const& dc, trie_map<nba_bitset, DetState>& existing,
     DetState const& cur, sym_t i, bool getAll=false) {
   // use Mueller/Schupp update for reference successor in trie query
   // TODO: make some override without replicating the whole thing
@@ -83,6 +131,22 @@ vector<DetState*> existing_succ(DetConf const& dc, trie_map<nba_bitset, DetState
   return cands;
 }
 
+// exploration state of determinize: (powerset, PA state)
+using DetBFSNode = pair<nba_bitset, state_t>;
+
+// save state of a running determinization (see DetConf::checkpoint), key identifies
+// the input and options. writes a temporary file first, so an old checkpoint
+// survives a crash during saving.
+void save_det_checkpoint(string const& file, string const& key, PA const& pa,
+    trie_map<nba_bitset, DetState> const& existing, unordered_set<state_t> const& expanded,
+    BFSState<DetBFSNode> const& bfsst, uint64_t numedges);
+
+// restore saved state into fresh (empty) structures. returns false if there
+// is no checkpoint or it belongs to another key.
+bool load_det_checkpoint(string const& file, string const& key, PA& pa,
+    trie_map<nba_bitset, DetState>& existing, unordered_set<state_t>& expanded,
+    BFSState<DetBFSNode>& bfsst, uint64_t& numedges);
+
 // BFS-based determinization with supplied level update config
 PA determinize(auto const& nba, DetConf const& dc, nba_bitset const& startset,
     auto const& pred, map<state_t, nba_bitset>* backmap = nullptr,
@@ -93,18 +157,37 @@ PA determinize(auto const& nba, DetConf const& dc, nba_bitset const& startset,
   auto pa = PA(false, nba.get_name(), nba.get_aps(), myinit);
   pa.set_patype(PAType::MIN_EVEN);
   pa.tag_to_str = default_printer<DetState>();
-  pa.tag.put(DetState(dc, startset), myinit); // initial state tag
 
   trie_map<nba_bitset, DetState> existing; //existing states organized in trie
-  existing.put(pa.tag.geti(myinit).to_tree_history(), pa.tag.geti(myinit));
-  // dc2.puretrees = false;
+  unordered_set<state_t> vis2nd;
+  BFSState<DetBFSNode> bfsst;
+  uint64_t numedges = 0;
+
+  //checkpoints are only supported for the plain exploration of the whole automaton
+  bool const checkpointing = !dc.checkpoint.empty() && !backmap && !altmap;
+  if (!(checkpointing && dc.resume
+        && load_det_checkpoint(dc.checkpoint, dc.checkpoint_key, pa, existing, vis2nd, bfsst, numedges))) {
+    pa.tag.put(DetState(dc, startset), myinit); // initial state tag
+    existing.put(pa.tag.geti(myinit).to_tree_history(), pa.tag.geti(myinit));
+    // dc2.puretrees = false;
+    bfsst.push(make_pair(startset, myinit));
+  }
+
+  Progress progress("determinize");
+  auto const starttime = get_time();
+  size_t budget_calls = 0;
+  auto lastcheckpoint = starttime;
+  auto const between_visits = [&]() {
+    if (checkpointing && get_secs_since(lastcheckpoint) >= dc.checkpoint_interval) {
+      save_det_checkpoint(dc.checkpoint, dc.checkpoint_key, pa, existing, vis2nd, bfsst, numedges);
+      lastcheckpoint = get_time();
+    }
+  };
 
-  int numvis=0;
   //always track normal successor powerset and det state in parallel
   if (backmap)
     (*backmap)[myinit] = startset;
-  unordered_set<state_t> vis2nd;
-  bfs(make_pair(startset, myinit), [&](auto const& stp, auto const& visit, auto const&) {
+  bfs(bfsst, [&](auto const& stp, auto const& visit, auto const&) {
     // get inner states of current macro state
     auto const cur = pa.tag.geti(stp.second);
 
@@ -113,9 +196,8 @@ PA determinize(auto const& nba, DetConf const& dc, nba_bitset const& startset,
     vis2nd.emplace(stp.second);
 
     // cout << "visit " << curlevel.to_string() << endl;
-    ++numvis;
-    if (numvis % 5000 == 0) //progress indicator
-      cerr << numvis << endl;
+    progress.add_state();
+    check_budget(dc, pa.num_states(), numedges, budget_calls, starttime);
 
     for (auto const i : pa.syms()) {
       // calculate successor level
@@ -185,10 +267,15 @@ PA determinize(auto const& nba, DetConf const& dc, nba_bitset const& startset,
       }
       // create edge
       pa.add_edge(stp.second, i, sucst, sucpri);
+      progress.add_edge();
+      numedges++;
       // schedule for bfs
       visit(make_pair(sucset, sucst));
     }
-  });
+  }, between_visits);
+
+  if (checkpointing) //finished, the checkpoint is useless now
+    remove(dc.checkpoint.c_str());
 
   // cerr << "In trie: " << existing.size() << endl;
   // collect alternative edge targets from trie
@@ -219,6 +306,185 @@ PA determinize(auto const& nba, DetConf const& dc) {
   return determinize(nba, dc, initset, const_true);
 }
 
+struct OutOfCoreStats {
+  size_t states;
+  size_t edges;
+  size_t disk_bytes;  // size of the state log
+  size_t index_bytes; // memory used by the index
+};
+
+// determinization of the whole NBA for outputs that do not fit into memory.
+// explores the same states in the same order as determinize(nba, dc) without
+// trie-based optimizations, but keeps the states in a DetStateStore in dir
+// and writes the DPA edges to a scratch file there while exploring.
+// the states are expanded in batches and duplicate detection is delayed to the end
+// of each batch: successors are sorted by fingerprint, so that repeated ones are
+// only looked up once, and the distinct ones are checked against the stored states
+// together, reading the log in one ascending pass. finally the complete HOA output
+// is written to out.
+OutOfCoreStats determinize_out_of_core(auto const& nba, DetConf const& dc, string const& dir,
+                                       ostream& out, size_t batch = 4096) {
+  assert(nba.is_buchi());
+  assert(!dc.opt_suc && !dc.hitset);
+
+  state_t maxnba = 0;
+  for (auto const p : nba.states())
+    maxnba = max(maxnba, p);
+  DetStateStore store(dir, maxnba + 1);
+
+  ScratchFile const bodyfile(dir, "body.hoa");
+  ofstream body(bodyfile.path);
+  if (!body)
+    throw runtime_error("cannot create " + bodyfile.path + "!");
+
+  nba_bitset initset = 0;
+  initset[nba.get_init()] = 1;
+  vector<uint8_t> buf;
+  store.encode(DetState(dc, initset), buf);
+  store.put_or_get(buf.data(), buf.size(), DetStateStore::fingerprint(buf.data(), buf.size()));
+
+  //successor edge computed in a batch, state bytes in batch buffer
+  struct PendingEdge {
+    state_t src;
+    sym_t sym;
+    pri_t pri;
+    uint64_t fp;
+    size_t off;
+    size_t len;
+  };
+
+  Progress progress("determinize");
+  auto const starttime = get_time();
+  size_t budget_calls = 0;
+  size_t numedges = 0;
+  pri_t maxpri = -1;
+  bool complete = true;
+  bool colored = true;
+  auto const syms = nba.syms();
+
+  for (state_t next = 0; next < store.size(); ) {
+    state_t const batchend = min(store.size(), next + batch);
+    vector<uint8_t> sucbytes;
+    vector<PendingEdge> pend;
+    vector<DetState> curs; //for printing the tags
+    {
+      PROF_PHASE("expand");
+      for (state_t p = next; p < batchend; p++) {
+        curs.push_back(store.get(p));
+        progress.add_state();
+        check_budget(dc, store.size(), numedges, budget_calls, starttime);
+
+        for (auto const i : syms) {
+          DetState suclevel;
+          pri_t sucpri;
+          tie(suclevel, sucpri) = curs.back().succ(dc, i);
+          if (suclevel.powerset == 0) {
+            complete = false;
+            continue;
+          }
+          store.encode(suclevel, buf);
+          pend.push_back(PendingEdge{p, i, sucpri, DetStateStore::fingerprint(buf.data(), buf.size()),
+                                     sucbytes.size(), buf.size()});
+          sucbytes.insert(sucbytes.end(), buf.begin(), buf.end());
+        }
+      }
+    }
+
+    //delayed duplicate detection: equal successors of the batch are adjacent after sorting,
+    //the first one (in exploration order) is looked up for all of them, all at once
+    vector<state_t> target(pend.size());
+    {
+      PROF_PHASE("dedup");
+      auto const bytes_less = [&](PendingEdge const& a, PendingEdge const& b) {
+        return lexicographical_compare(&sucbytes[a.off], &sucbytes[a.off] + a.len,
+                                       &sucbytes[b.off], &sucbytes[b.off] + b.len);
+      };
+      vector<size_t> order(pend.size());
+      for (size_t j = 0; j < order.size(); j++)
+        order[j] = j;
+      stable_sort(begin(order), end(order), [&](size_t a, size_t b) {
+        if (pend[a].fp != pend[b].fp)
+          return pend[a].fp < pend[b].fp;
+        return bytes_less(pend[a], pend[b]);
+      });
+      vector<size_t> rep(pend.size());
+      for (size_t j = 0; j < order.size(); j++) {
+        bool const dup = j > 0 && pend[order[j]].fp == pend[order[j-1]].fp
+                      && !bytes_less(pend[order[j-1]], pend[order[j]]);
+        rep[order[j]] = dup ? rep[order[j-1]] : order[j];
+      }
+      vector<StoreQuery> qs;
+      for (size_t j = 0; j < pend.size(); j++)
+        if (rep[j] == j)
+          qs.push_back(StoreQuery{pend[j].off, pend[j].len, pend[j].fp});
+      auto const ids = store.put_or_get_all(sucbytes.data(), qs);
+      for (size_t j = 0, k = 0; j < pend.size(); j++)
+        target[j] = rep[j] == j ? ids[k++] : target[rep[j]];
+    }
+
+    PROF_PHASE("write");
+    size_t j = 0;
+    for (state_t p = next; p < batchend; p++) {
+      body << "State: " << p << " \"" << curs[p - next] << "\"" << endl;
+      for (; j < pend.size() && pend[j].src == p; j++) {
+        body << "[" << sym_to_edgelabel(pend[j].sym, nba.get_aps()) << "] " << target[j];
+        if (pend[j].pri >= 0)
+          body << " {" << pend[j].pri << "}";
+        else
+          colored = false;
+        body << endl;
+        maxpri = max(maxpri, pend[j].pri);
+        progress.add_edge();
+        numedges++;
+      }
+    }
+    next = batchend;
+  }
+  body.close();
+  if (!body)
+    throw runtime_error("writing " + bodyfile.path + " failed!");
+
+  //header in the format of print_aut
+  PROF_PHASE("print");
+  out << "HOA: v1" << endl;
+  out << "name: \"" << nba.get_name() << "\"" << endl;
+  out << "States: " << store.size() << endl;
+  out << "Start: 0" << endl;
+  out << "AP: " << nba.get_aps().size();
+  for (auto const& ap : nba.get_aps())
+    out << " \"" << ap << "\"";
+  out << endl;
+  if (maxpri >= 0) {
+    int const pris = maxpri + 1;
+    out << "acc-name: parity min even " << pris << endl;
+    out << "Acceptance: " << pris << " ";
+    for (int a = 0; a < pris; a++) {
+      out << (a%2==0 ? "Inf" : "Fin") << "(" << a << ")";
+      if (a != pris-1)
+        out << (a%2==0 ? "|" : "&") << "(";
+    }
+    for (int a = 0; a < pris-1; a++)
+      out << ")";
+    out << endl;
+  } else {
+    out << "acc-name: none" << endl << "Acceptance: 0 f" << endl;
+  }
+  out << "properties: trans-labels explicit-labels deterministic";
+  if (colored)
+    out << " colored";
+  if (complete)
+    out << " complete";
+  out << endl;
+  out << "--BODY--" << endl;
+  {
+    ifstream in(bodyfile.path);
+    out << in.rdbuf();
+  }
+  out << "--END--" << endl;
+
+  return OutOfCoreStats{store.size(), numedges, store.disk_bytes(), store.index_bytes()};
+}
+
 //find smallest bottom SCC (bottom ensures that all powersets in PS SCC are reachable)
 int get_min_term_scc(auto const& succfun, SCCDat const& pai) {
     int mintermscc = -1;
@@ -238,7 +504,7 @@ int get_min_term_scc(auto const& succfun, SCCDat const& pai) {
 }
 
 // remove useless mappings, i.e. restrict to states in keep set
-void restrict_altmap(map<state_t, map<sym_t, vector<state_t>>>& altmap, set<state_t> const& keep) {
+inline void restrict_altmap(map<state_t, map<sym_t, vector<state_t>>>& altmap, set<state_t> const& keep) {
   // first remove outgoing
   auto altit = altmap.begin();
   while (altit != end(altmap)) {
@@ -262,6 +528,7 @@ void restrict_altmap(map<state_t, map<sym_t, vector<state_t>>>& altmap, set<stat
 
 // determinization of each powerset component separately, then fusing
 PA determinize(auto const& nba, DetConf const& dc, PS const& psa, SCCDat const& psai) {
+  auto const starttime = get_time();
   map<state_t, state_t> ps2pa;
   map<state_t, nba_bitset> origps;
   PA ret(false, nba.get_name(), nba.get_aps(), 0);
@@ -277,6 +544,8 @@ PA determinize(auto const& nba, DetConf const& dc, PS const& psa, SCCDat const&
     if (repps == 0) //empty powerset
       continue;
 
+    PROF_PHASE("pset_scc");
+
     // cerr << "repps: " << pretty_bitset(repps) << endl;
 
     //this map will map tuples with weird optimizations to the powerset states they represent
@@ -312,6 +581,7 @@ PA determinize(auto const& nba, DetConf const& dc, PS const& psa, SCCDat const&
     // restrict_altmap(altmap, set<state_t>(begin(sccstates),end(sccstates)));
 
     if (dc.hitset) {
+      PROF_PHASE("hitset");
       //also trim constraint map of alternative edge targets
       vector<state_t> hitset; //holds hitset in greedy order
       set<state_t> sccsts(sccstates.begin(), sccstates.end()); //holds hitset as set
@@ -323,6 +593,7 @@ PA determinize(auto const& nba, DetConf const& dc, PS const& psa, SCCDat const&
       size_t oldsz = 0;
       while (oldsz != sccsts.size()) {
         hitsetround++;
+        COUNT(hitset_rounds);
         oldsz = sccsts.size();
 
         // remove useless mappings
@@ -422,6 +693,7 @@ PA determinize(auto const& nba, DetConf const& dc, PS const& psa, SCCDat const&
               sccpa.remove_edge(st, sym, trg);
               sccpa.add_edge(st, sym, ntrg, pri);
               redirected++;
+              COUNT(edges_redirected);
             }
             // assert(sccpa.succ(st,sym).size()==1);
 
@@ -465,6 +737,15 @@ PA determinize(auto const& nba, DetConf const& dc, PS const& psa, SCCDat const&
     }
     ret.insert(sccpa);
 
+    //all kept parts together are subject to the state limit as well
+    if (dc.max_states && ret.num_states() > dc.max_states) {
+      size_t edges = 0;
+      for (auto const p : ret.states())
+        for (auto const x : ret.state_outsyms(p))
+          edges += ret.succ_edges(p, x).size();
+      throw BudgetExceeded("state", ret.num_states(), edges, get_secs_since(starttime), getCurrentRSS());
+    }
+
     // cerr << ret.num_states() << " " << origps.size() << endl;
     // cerr << "mintermscc: " << mintermscc << " , " << seq_to_str(sccstates) << " -- " << seq_to_str(sccpa.states()) << endl;
     // for (auto const st : sccstates) {
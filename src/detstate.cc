@@ -1,6 +1,8 @@
 #include "aut.hh"
 #include "detstate.hh"
 #include "common/util.hh"
+#include "metrics/counters.hh"
+#include "metrics/memstats.hh"
 #include <iostream>
 #include <algorithm>
 #include <bitset>
@@ -654,6 +656,8 @@ pri_t perform_actions(DetConf const& dc, DetConfSets const& sts,
 }
 
 pair<DetState, pri_t> DetState::succ(DetConf const& dc, sym_t x) const {
+  COUNT(succ_computed);
+  MEM_SCOPE(detstate);
   bool const& debug = dc.debug;
   if (debug) {
     cerr << "begin " << (int)x << " succ of: " << *this << endl;
@@ -6,6 +6,7 @@
 #include <ostream>
 
 #include "aut.hh"
+#include "metrics/profiler.hh"
 #include "common/scc.hh"
 #include "preproc.hh"
 #include "ps.hh"
@@ -84,6 +85,18 @@ struct DetConf {
   bool hitset = false;
 
   bool z = false; //for experiments. debugging flag to toggle some behaviour
+
+  //resource limits checked during exploration (0 = unlimited)
+  size_t max_states = 0;
+  size_t max_memory = 0;      //resident memory in bytes
+  bool has_deadline = false;
+  timepoint_t deadline;
+
+  //periodic checkpoints of the exploration (empty file = disabled)
+  string checkpoint;
+  string checkpoint_key;          //identifies input and options
+  double checkpoint_interval = 600; //seconds
+  bool resume = false;            //continue from existing checkpoint
 };
 
 DetConfSets calc_detconfsets(DetConf const& dc, SCCDat const& scci,
@@ -1,11 +1,13 @@
 #pragma once
 
+#include <cstdint>
 #include <queue>
 #include <set>
 #include <vector>
 #include <map>
 
 #include "common/util.hh"
+#include "common/scc.hh"
 #include "aut.hh"
 
 namespace nbautils {
@@ -34,6 +36,64 @@ vector<state_t> unreachable_states(Aut<T> const& g, state_t from) {
 }
 
 
+//reachability between all states of a graph, computed once by a closure over the SCC DAG.
+//each SCC has a bitset row of the SCCs it reaches (including itself),
+//so the memory is quadratic in the number of SCCs (intended for NBAs)
+class ReachIndex {
+  SCCDat scci;
+  size_t words = 0;
+  vector<uint64_t> rows; //row of SCC i starts at i*words
+
+  uint64_t* row(unsigned i) { return &rows[i * words]; }
+
+public:
+  //takes SCCs of the graph and a function that supplies successors of a state
+  template <typename F>
+  ReachIndex(SCCDat sccdat, F const& get_succs) : scci(move(sccdat)) {
+    unsigned const n = scci.sccs.size();
+    words = (n + 63) / 64;
+    rows.assign(n * words, 0);
+
+    //SCCs are numbered such that successor SCCs come first -> one pass suffices
+    for (unsigned i = 0; i < n; i++) {
+      uint64_t* const r = row(i);
+      r[i / 64] |= uint64_t(1) << (i % 64);
+      for (auto const st : scci.sccs.at(i)) {
+        for (auto const suc : get_succs(st)) {
+          unsigned const j = scci.scc_of.at(suc);
+          if (scc_reaches(i, j))
+            continue;
+          assert(j < i);
+          uint64_t const* const sucr = row(j);
+          for (size_t w = 0; w < words; w++)
+            r[w] |= sucr[w];
+        }
+      }
+    }
+  }
+
+  //takes all states of the graph and a function that supplies successors of a state
+  template <typename Range, typename F>
+  ReachIndex(Range const& states, F const& get_succs)
+    : ReachIndex(get_sccs(states, get_succs), get_succs) {}
+
+  SCCDat const& sccs() const { return scci; }
+
+  bool scc_reaches(unsigned i, unsigned j) const {
+    return (rows[i * words + j / 64] >> (j % 64)) & 1;
+  }
+
+  //is b reachable from a? (every state reaches itself)
+  bool reaches(state_t a, state_t b) const {
+    return scc_reaches(scci.scc_of.at(a), scci.scc_of.at(b));
+  }
+};
+
+template <typename T>
+ReachIndex reach_index(Aut<T> const& g) {
+  return ReachIndex(g.states(), aut_succ(g));
+}
+
 //returns a Node sequence with start and target included, if a path is found
 template <typename T>
 vector<state_t> find_path_from_to(Aut<T> const& g, state_t from, state_t to) {
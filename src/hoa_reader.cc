@@ -0,0 +1,712 @@
+#include "hoa_reader.hh"
+
+#include <cctype>
+#include <cstdio>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "metrics/profiler.hh"
+
+namespace nbautils {
+using namespace std;
+
+MappedInput::MappedInput(string const& filename) {
+  if (filename.empty()) {
+    buf.assign(istreambuf_iterator<char>(cin), istreambuf_iterator<char>());
+    return;
+  }
+
+  int const fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0)
+    throw runtime_error("Could not open file: " + filename);
+
+  struct stat st;
+  if (fstat(fd, &st) == 0 && st.st_size > 0) {
+    len = st.st_size;
+    map = mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED) { //e.g. a named pipe - just read it
+      map = nullptr;
+      len = 0;
+    } else {
+      madvise(map, len, MADV_SEQUENTIAL);
+    }
+  }
+  if (!map) {
+    char tmp[1 << 16];
+    ssize_t r;
+    while ((r = read(fd, tmp, sizeof(tmp))) > 0)
+      buf.append(tmp, r);
+  }
+  close(fd);
+}
+
+MappedInput::~MappedInput() {
+  if (map)
+    munmap(map, len);
+}
+
+string_view MappedInput::data() const {
+  if (map)
+    return string_view(static_cast<char const*>(map), len);
+  return string_view(buf);
+}
+
+// ----------------------------------------------------------------------------
+
+namespace {
+
+// HOA comments can be nested. pos points at the "/*", afterwards behind the "*/".
+// returns false if the input ends inside of the comment
+bool skip_comment(string_view s, size_t& pos) {
+  int depth = 0;
+  while (pos < s.size()) {
+    if (s.compare(pos, 2, "/*") == 0) {
+      depth++;
+      pos += 2;
+    } else if (s.compare(pos, 2, "*/") == 0) {
+      depth--;
+      pos += 2;
+      if (depth == 0)
+        return true;
+    } else {
+      pos++;
+    }
+  }
+  return false;
+}
+
+// pos points at opening quote, afterwards behind the closing quote.
+// returns false if the input ends inside of the string
+bool skip_string(string_view s, size_t& pos) {
+  pos++;
+  while (pos < s.size() && s[pos] != '"') {
+    if (s[pos] == '\\')
+      pos++;
+    pos++;
+  }
+  if (pos >= s.size())
+    return false;
+  pos++;
+  return true;
+}
+
+// contents of a string token without the backslash escapes
+string unescape(string_view s) {
+  string ret;
+  ret.reserve(s.size());
+  for (size_t i = 0; i < s.size(); i++) {
+    if (s[i] == '\\' && i+1 < s.size())
+      i++;
+    ret += s[i];
+  }
+  return ret;
+}
+
+bool is_ident_start(char c) { return isalpha((unsigned char)c) || c == '_'; }
+bool is_ident_char(char c) { return isalnum((unsigned char)c) || c == '_' || c == '-'; }
+
+struct Token {
+  enum Type { INT, STRING, IDENT, HEADER, LBRACK, RBRACK, LBRACE, RBRACE,
+              LPAREN, RPAREN, NOT, AND, OR, ALIAS, BODY, END, ABORT, EOI };
+  Type type = EOI;
+  string_view text;
+  unsigned long val = 0;
+};
+
+class Lexer {
+  string_view s;
+  size_t pos = 0;
+  size_t tokstart = 0;
+  Token cur;
+
+  void advance() {
+    //skip whitespace and comments
+    while (pos < s.size()) {
+      if (isspace((unsigned char)s[pos]))
+        pos++;
+      else if (s.compare(pos, 2, "/*") == 0) {
+        if (!skip_comment(s, pos))
+          throw runtime_error("Unterminated comment!");
+      }
+      else
+        break;
+    }
+
+    cur = Token();
+    tokstart = pos;
+    if (pos >= s.size())
+      return;
+
+    size_t const start = pos;
+    char const c = s[pos];
+    auto const single = [&](Token::Type t) { cur.type = t; cur.text = s.substr(start, 1); pos++; };
+
+    switch (c) {
+      case '[': single(Token::LBRACK); return;
+      case ']': single(Token::RBRACK); return;
+      case '{': single(Token::LBRACE); return;
+      case '}': single(Token::RBRACE); return;
+      case '(': single(Token::LPAREN); return;
+      case ')': single(Token::RPAREN); return;
+      case '!': single(Token::NOT); return;
+      case '&': single(Token::AND); return;
+      case '|': single(Token::OR); return;
+      default: break;
+    }
+
+    if (c == '"') {
+      if (!skip_string(s, pos))
+        throw runtime_error("Unterminated string!");
+      cur.type = Token::STRING;
+      cur.text = s.substr(start+1, pos-start-2);
+    } else if (isdigit((unsigned char)c)) {
+      while (pos < s.size() && isdigit((unsigned char)s[pos])) {
+        cur.val = 10*cur.val + (s[pos]-'0');
+        pos++;
+      }
+      cur.type = Token::INT;
+      cur.text = s.substr(start, pos-start);
+    } else if (c == '@') {
+      pos++;
+      while (pos < s.size() && is_ident_char(s[pos])) pos++;
+      cur.type = Token::ALIAS;
+      cur.text = s.substr(start, pos-start);
+    } else if (s.compare(pos, 8, "--BODY--") == 0) {
+      pos += 8; cur.type = Token::BODY;
+    } else if (s.compare(pos, 7, "--END--") == 0) {
+      pos += 7; cur.type = Token::END;
+    } else if (s.compare(pos, 9, "--ABORT--") == 0) {
+      pos += 9; cur.type = Token::ABORT;
+    } else if (is_ident_start(c)) {
+      while (pos < s.size() && is_ident_char(s[pos])) pos++;
+      cur.text = s.substr(start, pos-start);
+      cur.type = Token::IDENT;
+      if (pos < s.size() && s[pos] == ':') {
+        pos++;
+        cur.type = Token::HEADER;
+      }
+    } else {
+      throw runtime_error("Unexpected character '" + string(1, c) + "' in HOA input!");
+    }
+  }
+
+public:
+  explicit Lexer(string_view src) : s(src) { advance(); }
+
+  Token const& peek() const { return cur; }
+  size_t offset() const { return tokstart; } //start of current token in input
+  Token next() { Token t = cur; advance(); return t; }
+
+  Token expect(Token::Type t, char const* what) {
+    if (cur.type != t)
+      throw runtime_error(string("Expected ") + what + " in HOA input!");
+    return next();
+  }
+
+  //raw text up to (excluding) next closing bracket, consumes the bracket
+  string_view raw_label() {
+    //current token is the first token of the label, rewind to its start
+    size_t const start = tokstart;
+    size_t const end = s.find(']', start);
+    if (end == string_view::npos)
+      throw runtime_error("Unterminated label!");
+    pos = end+1;
+    advance();
+    return s.substr(start, end-start);
+  }
+};
+
+}  // namespace
+
+// ----------------------------------------------------------------------------
+
+string_view next_hoa_chunk(string_view buf, size_t& pos, bool complete) {
+  size_t const n = buf.size();
+  //skip leading whitespace to find start of automaton
+  while (pos < n && isspace((unsigned char)buf[pos]))
+    pos++;
+  size_t const start = pos;
+
+  char const* unterminated = nullptr; //the input ends in a string or comment
+  while (pos < n && !unterminated) {
+    char const c = buf[pos];
+    if (c == '"') {
+      if (!skip_string(buf, pos))
+        unterminated = "Unterminated string!";
+    } else if (c == '/' && buf.compare(pos, 2, "/*") == 0) {
+      if (!skip_comment(buf, pos))
+        unterminated = "Unterminated comment!";
+    } else if (c == '-' && buf.compare(pos, 7, "--END--") == 0) {
+      pos += 7;
+      return buf.substr(start, pos-start);
+    } else if (c == '-' && buf.compare(pos, 9, "--ABORT--") == 0) {
+      pos += 9;
+      return buf.substr(start, pos-start);
+    } else {
+      pos++;
+    }
+  }
+  if (start < n && complete)
+    throw runtime_error(unterminated ? unterminated : "Incomplete automaton at end of input!");
+  if (!complete) //need more input
+    pos = start;
+  return {};
+}
+
+// ----------------------------------------------------------------------------
+
+SymTable::SymTable(unsigned numsyms, bool val)
+  : nsyms(numsyms), words((numsyms+63)/64, val ? ~uint64_t(0) : 0) {
+  if (val && nsyms % 64)
+    words.back() &= (uint64_t(1) << (nsyms % 64)) - 1;
+}
+
+SymTable SymTable::atom(unsigned numsyms, unsigned apidx) {
+  //bit patterns of the lowest 6 APs inside of one word
+  static uint64_t const pat[6] = {
+    0xAAAAAAAAAAAAAAAAULL, 0xCCCCCCCCCCCCCCCCULL, 0xF0F0F0F0F0F0F0F0ULL,
+    0xFF00FF00FF00FF00ULL, 0xFFFF0000FFFF0000ULL, 0xFFFFFFFF00000000ULL };
+
+  SymTable ret(numsyms);
+  for (size_t w = 0; w < ret.words.size(); w++) {
+    if (apidx < 6)
+      ret.words[w] = pat[apidx];
+    else //higher APs select whole words
+      ret.words[w] = ((w >> (apidx-6)) & 1) ? ~uint64_t(0) : 0;
+  }
+  if (numsyms % 64)
+    ret.words.back() &= (uint64_t(1) << (numsyms % 64)) - 1;
+  return ret;
+}
+
+SymTable& SymTable::operator&=(SymTable const& o) {
+  for (size_t w = 0; w < words.size(); w++)
+    words[w] &= o.words[w];
+  return *this;
+}
+
+SymTable& SymTable::operator|=(SymTable const& o) {
+  for (size_t w = 0; w < words.size(); w++)
+    words[w] |= o.words[w];
+  return *this;
+}
+
+SymTable& SymTable::flip() {
+  for (auto& w : words)
+    w = ~w;
+  if (nsyms % 64)
+    words.back() &= (uint64_t(1) << (nsyms % 64)) - 1;
+  return *this;
+}
+
+void SymTable::collect(vector<sym_t>& out) const {
+  for (size_t w = 0; w < words.size(); w++) {
+    uint64_t bits = words[w];
+    while (bits) {
+      out.push_back(w*64 + __builtin_ctzll(bits));
+      bits &= bits - 1;
+    }
+  }
+}
+
+// ----------------------------------------------------------------------------
+
+namespace {
+
+//recursive descent over label tokens, evaluates to truth table
+struct LabelParser {
+  Lexer& lex;
+  LabelCompiler& lc;
+  vector<SymTable> const& atoms;
+  unsigned nsyms;
+
+  SymTable parse_or() {
+    SymTable ret = parse_and();
+    while (lex.peek().type == Token::OR) {
+      lex.next();
+      ret |= parse_and();
+    }
+    return ret;
+  }
+
+  SymTable parse_and() {
+    SymTable ret = parse_not();
+    while (lex.peek().type == Token::AND) {
+      lex.next();
+      ret &= parse_not();
+    }
+    return ret;
+  }
+
+  SymTable parse_not() {
+    if (lex.peek().type == Token::NOT) {
+      lex.next();
+      return parse_not().flip();
+    }
+    return parse_atom();
+  }
+
+  SymTable parse_atom() {
+    Token const t = lex.next();
+    switch (t.type) {
+      case Token::INT:
+        if (t.val >= atoms.size())
+          throw runtime_error("Label refers to undeclared atomic proposition!");
+        return atoms[t.val];
+      case Token::IDENT:
+        if (t.text == "t") return SymTable(nsyms, true);
+        if (t.text == "f") return SymTable(nsyms, false);
+        break;
+      case Token::LPAREN: {
+        SymTable ret = parse_or();
+        lex.expect(Token::RPAREN, "')'");
+        return ret;
+      }
+      case Token::ALIAS:
+        return lc.alias(t.text);
+      default:
+        break;
+    }
+    throw runtime_error("Invalid label expression!");
+  }
+};
+
+//if label is a conjunction of literals, fills masks and returns true
+bool parse_cube(string_view lbl, unsigned numaps, sym_t& care, sym_t& val, bool& unsat) {
+  care = 0; val = 0; unsat = false;
+  size_t i = 0;
+  auto const skipws = [&]{ while (i < lbl.size() && isspace((unsigned char)lbl[i])) i++; };
+  while (true) {
+    skipws();
+    bool neg = false;
+    if (i < lbl.size() && lbl[i] == '!') {
+      neg = true;
+      i++;
+      skipws();
+    }
+    if (i >= lbl.size())
+      return false;
+
+    if (isdigit((unsigned char)lbl[i])) {
+      unsigned ap = 0;
+      while (i < lbl.size() && isdigit((unsigned char)lbl[i]))
+        ap = 10*ap + (lbl[i++]-'0');
+      if (ap >= numaps)
+        throw runtime_error("Label refers to undeclared atomic proposition!");
+      sym_t const bit = 1 << ap;
+      if ((care & bit) && (((val & bit) != 0) == neg))
+        unsat = true; //contradicting literals
+      care |= bit;
+      if (!neg)
+        val |= bit;
+    } else if ((lbl[i] == 't' || lbl[i] == 'f')
+               && (i+1 == lbl.size() || !is_ident_char(lbl[i+1]))) {
+      if ((lbl[i] == 't') == neg)
+        unsat = true;
+      i++;
+    } else {
+      return false;
+    }
+
+    skipws();
+    if (i == lbl.size())
+      return true;
+    if (lbl[i] != '&')
+      return false;
+    i++;
+  }
+}
+
+}  // namespace
+
+LabelCompiler::LabelCompiler(unsigned aps) : numaps(aps) {
+  for (unsigned i = 0; i < numaps; i++)
+    atoms.push_back(SymTable::atom(1u << numaps, i));
+}
+
+void LabelCompiler::add_alias(string_view name, string_view expr) {
+  aliases[name] = expr;
+}
+
+SymTable const& LabelCompiler::alias(string_view name) {
+  auto it = alias_tabs.find(name);
+  if (it != alias_tabs.end())
+    return it->second;
+
+  if (!map_has_key(aliases, name))
+    throw runtime_error("Undefined alias " + string(name) + "!");
+  if (++alias_depth > 64)
+    throw runtime_error("Aliases are defined recursively!");
+
+  Lexer lex(aliases.at(name));
+  LabelParser p{lex, *this, atoms, 1u << numaps};
+  SymTable tab = p.parse_or();
+  if (lex.peek().type != Token::EOI)
+    throw runtime_error("Invalid alias expression!");
+
+  --alias_depth;
+  return alias_tabs.emplace(name, move(tab)).first->second;
+}
+
+vector<sym_t> const& LabelCompiler::compile(string_view label) {
+  auto it = memo.find(label);
+  if (it != memo.end())
+    return it->second;
+
+  vector<sym_t> syms;
+  sym_t care, val;
+  bool unsat;
+  if (parse_cube(label, numaps, care, val, unsat)) {
+    //expand cube directly by enumerating all assignments of the free APs
+    if (!unsat) {
+      unsigned const all = (1u << numaps) - 1;
+      unsigned const freebits = all & ~care;
+      unsigned sub = 0;
+      do {
+        syms.push_back(val | sub);
+        sub = (sub - freebits) & freebits; //next subset of free bits (ascending)
+      } while (sub != 0);
+    }
+  } else {
+    Lexer lex(label);
+    LabelParser p{lex, *this, atoms, 1u << numaps};
+    SymTable const tab = p.parse_or();
+    if (lex.peek().type != Token::EOI)
+      throw runtime_error("Invalid label expression!");
+    tab.collect(syms);
+  }
+
+  return memo.emplace(label, move(syms)).first->second;
+}
+
+// ----------------------------------------------------------------------------
+
+namespace {
+
+//optional {i j ...} acceptance signature, returns -1 if not present
+pri_t parse_accsig(Lexer& lex, char const* what) {
+  if (lex.peek().type != Token::LBRACE)
+    return -1;
+  lex.next();
+  pri_t ret = -1;
+  int cnt = 0;
+  while (lex.peek().type == Token::INT) {
+    ret = lex.next().val;
+    cnt++;
+  }
+  lex.expect(Token::RBRACE, "'}'");
+  if (cnt > 1)
+    throw runtime_error(string(what) + " can have only one priority mark!");
+  return ret;
+}
+
+void add_edge_once(Aut<string>& aut, state_t p, sym_t x, state_t q, pri_t pri) {
+  if (!aut.has_state(q))
+    aut.add_state(q);
+  if (!aut.has_edge(p, x, q))
+    aut.add_edge(p, x, q, pri);
+}
+
+void log_error(std::shared_ptr<spdlog::logger> const& log, char const* msg) {
+  if (log)
+    log->error(msg);
+  else
+    std::cerr << msg << std::endl;
+}
+
+}  // namespace
+
+// mirrors the behaviour of MyConsumer<Aut<string>> in io.hh
+Aut<string> parse_hoa(string_view src) {
+  if (src.size() >= 9 && src.substr(src.size()-9) == "--ABORT--")
+    throw runtime_error("Automaton was aborted (--ABORT--)!");
+
+  Lexer lex(src);
+  Aut<string> aut;
+
+  // -- header --
+  if (lex.peek().type != Token::HEADER || lex.peek().text != "HOA")
+    throw runtime_error("Input does not start with 'HOA:'!");
+
+  bool has_start = false;
+  vector<string> aps;
+  vector<pair<string_view, string_view>> aliases;
+  while (lex.peek().type == Token::HEADER) {
+    string_view const hdr = lex.next().text;
+
+    if (hdr == "name") {
+      aut.set_name(unescape(lex.expect(Token::STRING, "name").text));
+    } else if (hdr == "Start") {
+      if (has_start)
+        throw runtime_error("There must be exactly one initial state!");
+      state_t const init = lex.expect(Token::INT, "initial state").val;
+      if (lex.peek().type == Token::AND)
+        throw runtime_error("There must be exactly one initial state!");
+      if (!aut.has_state(init))
+        aut.add_state(init);
+      aut.set_init(init);
+      has_start = true;
+    } else if (hdr == "AP") {
+      unsigned const num = lex.expect(Token::INT, "number of APs").val;
+      for (unsigned i = 0; i < num; i++)
+        aps.push_back(unescape(lex.expect(Token::STRING, "AP name").text));
+      if (num > 8 * sizeof(sym_t))
+        throw runtime_error("Too many atomic propositions!");
+      aut.set_aps(aps);
+    } else if (hdr == "acc-name") {
+      string_view const name = lex.expect(Token::IDENT, "acceptance name").text;
+      if (name != "Buchi" && name != "parity")
+        throw runtime_error("Automaton does not have Büchi or Parity acceptance!");
+      if (name == "parity") {
+        PAType pat = PAType::MIN_EVEN;
+        if (lex.expect(Token::IDENT, "parity polarity").text != "min")
+          pat = opposite_polarity(pat);
+        if (lex.expect(Token::IDENT, "parity type").text != "even")
+          pat = opposite_parity(pat);
+        aut.set_patype(pat);
+      }
+    } else if (hdr == "Alias") {
+      string_view const name = lex.expect(Token::ALIAS, "alias name").text;
+      size_t const start = lex.offset();
+      while (lex.peek().type != Token::HEADER && lex.peek().type != Token::BODY
+          && lex.peek().type != Token::EOI)
+        lex.next();
+      aliases.emplace_back(name, src.substr(start, lex.offset()-start));
+    }
+
+    //skip remaining values of this header item (or all of an ignored one)
+    while (lex.peek().type != Token::HEADER && lex.peek().type != Token::BODY
+        && lex.peek().type != Token::EOI)
+      lex.next();
+  }
+  lex.expect(Token::BODY, "--BODY--");
+
+  // -- body --
+  LabelCompiler lc(aps.size());
+  for (auto const& it : aliases)
+    lc.add_alias(it.first, it.second);
+  bool fixed_sbatba = false;
+
+  while (lex.peek().type == Token::HEADER && lex.peek().text == "State") {
+    lex.next();
+
+    //state label: applies to all unlabeled edges
+    vector<sym_t> const* statelbl = nullptr;
+    if (lex.peek().type == Token::LBRACK) {
+      lex.next();
+      statelbl = &lc.compile(lex.raw_label());
+    }
+
+    state_t const id = lex.expect(Token::INT, "state id").val;
+    if (!aut.has_state(id))
+      aut.add_state(id);
+
+    string info = to_string(id); //if untagged, we tag with the original id number
+    if (lex.peek().type == Token::STRING)
+      info = unescape(lex.next().text);
+
+    pri_t const spri = parse_accsig(lex, "State");
+    if (spri >= 0) {
+      if (fixed_sbatba && !aut.is_sba())
+        throw runtime_error("Priorities should be either at states or at edges!");
+      if (!fixed_sbatba) {
+        aut.set_sba(true);
+        fixed_sbatba = true;
+      }
+      aut.set_pri(id, spri);
+    }
+    aut.tag.put(info, id);
+
+    //edges
+    sym_t implicit = 0;
+    while (true) {
+      Token::Type const tt = lex.peek().type;
+      if (tt != Token::LBRACK && tt != Token::INT)
+        break;
+
+      vector<sym_t> const* lbl = statelbl;
+      if (tt == Token::LBRACK) {
+        lex.next();
+        lbl = &lc.compile(lex.raw_label());
+      }
+
+      state_t const trg = lex.expect(Token::INT, "successor").val;
+      if (lex.peek().type == Token::AND)
+        throw runtime_error("Universal branching is not supported!");
+
+      pri_t const epri = parse_accsig(lex, "Transition");
+      if (epri >= 0 && !fixed_sbatba)
+        fixed_sbatba = true;
+      if (fixed_sbatba && epri >= 0 && aut.is_sba())
+        throw runtime_error("Priorities should be either at states or at edges!");
+
+      if (lbl) {
+        for (sym_t const x : *lbl)
+          add_edge_once(aut, id, x, trg, epri);
+      } else { //implicit labels: n-th edge has n-th symbol
+        if (implicit >= aut.num_syms())
+          throw runtime_error("Too many implicitly labeled edges!");
+        add_edge_once(aut, id, implicit++, trg, epri);
+      }
+    }
+  }
+
+  lex.expect(Token::END, "--END--");
+
+  if (!fixed_sbatba) //automaton without acceptance sets can be seen as statebased
+    aut.set_sba(true);
+  aut.tag_to_str = default_printer<string>();
+  return aut;
+}
+
+// ----------------------------------------------------------------------------
+
+HOAStream::HOAStream(string const& filename, std::shared_ptr<spdlog::logger> logger)
+  : log(logger) {
+  try {
+    input = make_unique<MappedInput>(filename);
+  } catch (std::exception& e) {
+    log_error(log, e.what());
+  }
+}
+
+bool HOAStream::has_next() {
+  if (!input)
+    return false;
+  string_view const buf = input->data();
+  while (!lookahead) {
+    string_view chunk;
+    try {
+      chunk = next_hoa_chunk(buf, pos);
+    } catch (std::exception& e) { //can not find the end of the automaton
+      log_error(log, e.what());
+      pos = buf.size();
+    }
+    if (chunk.empty())
+      return false;
+
+    try {
+      PROF_PHASE("parse");
+      lookahead = make_unique<Aut<string>>(parse_hoa(chunk));
+    } catch (std::exception& e) { //broken automaton, continue with next one
+      log_error(log, e.what());
+    }
+  }
+  return true;
+}
+
+Aut<string> HOAStream::parse_next() {
+  if (!has_next())
+    return {};
+  Aut<string> ret = move(*lookahead);
+  lookahead.reset();
+  return ret;
+}
+
+}  // namespace nbautils
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <spdlog/spdlog.h>
+
+#include "aut.hh"
+
+// native reader for the HOA subset we actually consume (Büchi/parity acceptance,
+// explicit or implicit labels, exactly one initial state, aliases, no universal branching).
+// avoids the cpphoafparser event interface and the per-letter evaluation of label trees:
+// each distinct label text is compiled once into the list of symbols it accepts.
+
+namespace nbautils {
+using namespace std;
+
+// whole input in memory: a file is mapped read-only, stdin is slurped into a buffer
+class MappedInput {
+  void* map = nullptr;
+  size_t len = 0;
+  string buf;
+
+public:
+  // empty filename = read from stdin
+  explicit MappedInput(string const& filename);
+  ~MappedInput();
+  MappedInput(MappedInput const&) = delete;
+  MappedInput& operator=(MappedInput const&) = delete;
+
+  string_view data() const;
+};
+
+// find next automaton in buffer starting at pos (skipping comments and strings while
+// looking for the terminator). returns chunk including --END--/--ABORT--, advances pos.
+// returns empty view if no further (complete) automaton is present.
+// an unterminated automaton at the end is an error, unless the buffer is
+// marked as incomplete (more input may follow), then pos stays at its start.
+string_view next_hoa_chunk(string_view buf, size_t& pos, bool complete=true);
+
+// set of symbols (valuations of <= 16 APs) as bitvector, used to compile edge labels
+class SymTable {
+  unsigned nsyms = 0;
+  vector<uint64_t> words;
+
+public:
+  SymTable(unsigned numsyms, bool val=false);
+
+  // table of all symbols where AP with given index is true
+  static SymTable atom(unsigned numsyms, unsigned apidx);
+
+  SymTable& operator&=(SymTable const& o);
+  SymTable& operator|=(SymTable const& o);
+  SymTable& flip();
+
+  // append all contained symbols in increasing order
+  void collect(vector<sym_t>& out) const;
+};
+
+// compiles label expressions to sorted symbol lists, memoized by label text
+// (the memo keys point into the input buffer, which must outlive the compiler)
+class LabelCompiler {
+  unsigned numaps;
+  vector<SymTable> atoms; //precomputed truth tables of APs
+  unordered_map<string_view, vector<sym_t>> memo;
+
+  unordered_map<string_view, string_view> aliases; //@name -> expression text
+  unordered_map<string_view, SymTable> alias_tabs; //compiled on first use
+  int alias_depth = 0;
+
+public:
+  explicit LabelCompiler(unsigned aps);
+
+  void add_alias(string_view name, string_view expr);
+  SymTable const& alias(string_view name);
+
+  vector<sym_t> const& compile(string_view label);
+};
+
+// parse exactly one automaton from given chunk. throws runtime_error on problems.
+Aut<string> parse_hoa(string_view src);
+
+// drop-in replacement for AutStream<Aut<string>> on top of the native reader.
+// broken automata are logged and skipped, the stream continues with the next one.
+class HOAStream {
+  unique_ptr<MappedInput> input;
+  size_t pos = 0;
+  unique_ptr<Aut<string>> lookahead;
+  std::shared_ptr<spdlog::logger> log;
+
+public:
+  HOAStream(string const& filename, std::shared_ptr<spdlog::logger> logger=nullptr);
+
+  bool has_next();
+  Aut<string> parse_next();
+};
+
+}  // namespace nbautils
@@ -0,0 +1,51 @@
+#include <cassert>
+
+#include "lazydet.hh"
+
+namespace nbautils {
+using namespace std;
+
+constexpr state_t LazyDPA::none;
+
+LazyDPA::LazyDPA(DetConf const& dc, nba_bitset const& startset, size_t cache_size)
+  : dc(dc), nsyms(dc.aut_mat.size()), cache_size(max<size_t>(1, cache_size)) {
+  assert(!dc.opt_suc && !dc.hitset);
+  put_or_get(DetState(dc, startset));
+}
+
+state_t LazyDPA::put_or_get(DetState&& ds) {
+  auto const it = ids.emplace(move(ds), states.size());
+  if (it.second)
+    states.push_back(&it.first->first);
+  return it.first->second;
+}
+
+pair<state_t, pri_t> LazyDPA::successor(state_t s, sym_t x) {
+  assert(s < states.size() && x < nsyms);
+  CacheKey const key = CacheKey(s) * nsyms + x;
+
+  auto const it = cache.find(key);
+  if (it != cache.end()) {
+    hits++;
+    lru.splice(lru.begin(), lru, it->second.second); //mark as most recently used
+    return it->second.first;
+  }
+  misses++;
+
+  DetState suclevel;
+  pri_t sucpri;
+  tie(suclevel, sucpri) = states[s]->succ(dc, x);
+  pair<state_t, pri_t> ret(none, 0);
+  if (suclevel.powerset != 0) //empty set -> no successor
+    ret = make_pair(put_or_get(move(suclevel)), sucpri);
+
+  if (cache.size() >= cache_size) { //drop least recently used
+    cache.erase(lru.back());
+    lru.pop_back();
+  }
+  lru.push_front(key);
+  cache.emplace(key, make_pair(ret, lru.begin()));
+  return ret;
+}
+
+}  // namespace nbautils
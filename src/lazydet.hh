@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <list>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "common/types.hh"
+#include "detstate.hh"
+
+// implicit DPA for consumers that only need the part of the determinized automaton
+// that they actually visit, e.g. a product with a system or a game.
+// the states are computed on demand and are the same as in determinize(nba, dc)
+// (without trie-based optimizations). a state keeps its id once it was seen,
+// successors are memoized in a cache of bounded size that drops the least
+// recently used entries (they are recomputed when needed again).
+
+namespace nbautils {
+using namespace std;
+
+class LazyDPA {
+  DetConf const& dc;
+  size_t const nsyms; //not sym_t, 2^16 symbols do not fit
+
+  unordered_map<DetState, state_t> ids;
+  vector<DetState const*> states; // id -> key in ids (stable)
+
+  using CacheKey = uint64_t; // state id * nsyms + sym
+  size_t const cache_size;
+  list<CacheKey> lru; // most recently used first
+  unordered_map<CacheKey, pair<pair<state_t, pri_t>, list<CacheKey>::iterator>> cache;
+  size_t hits = 0;
+  size_t misses = 0;
+
+  state_t put_or_get(DetState&& ds);
+
+public:
+  // returned as successor state if there is no successor (empty powerset)
+  static constexpr state_t none = numeric_limits<state_t>::max();
+
+  // dc must outlive the LazyDPA, startset is usually {initial state of the NBA}
+  LazyDPA(DetConf const& dc, nba_bitset const& startset, size_t cache_size = size_t(1) << 20);
+  LazyDPA(LazyDPA const&) = delete;
+  LazyDPA& operator=(LazyDPA const&) = delete;
+
+  PAType get_patype() const { return PAType::MIN_EVEN; }
+  size_t num_syms() const { return nsyms; }
+
+  state_t initial() const { return 0; }
+
+  // successor state and edge priority (none if there is no successor)
+  pair<state_t, pri_t> successor(state_t s, sym_t x);
+
+  DetState const& state(state_t s) const { return *states.at(s); }
+
+  // number of states seen so far
+  size_t num_states() const { return states.size(); }
+
+  size_t cache_hits() const { return hits; }
+  size_t cache_misses() const { return misses; }
+};
+
+}  // namespace nbautils
@@ -1,26 +1,18 @@
 #pragma once
-#include <chrono>
 #include <string>
 
 #include <spdlog/spdlog.h>
 
-using timepoint_t = std::chrono::high_resolution_clock::time_point;
-using duration_t = std::chrono::high_resolution_clock::duration;
-
-inline timepoint_t get_time() { return std::chrono::high_resolution_clock::now(); }
-
-inline double duration_to_sec(duration_t const& tp) {
-  return std::chrono::duration_cast<std::chrono::duration<double>>(tp).count();
-}
-
-inline double get_secs_since(timepoint_t const& tp) { return duration_to_sec(get_time() - tp); }
+#include "profiler.hh"
 
 //any function can be benchmarked in the log like this:
 //  bench(logger, "function name", WRAP(function_call(args)));
-//the optional trailing argument can be used to toggle output
+//the optional trailing argument can be used to toggle output.
+//the call is also recorded as profiler phase with the given name.
 #define WRAP(x) ([&](){return std::move(x);})
 template<typename F>
 auto bench(std::shared_ptr<spdlog::logger> log, std::string name, F f, bool enabled=true) {
+  ProfPhase phase(name.c_str());
   timepoint_t starttime;
   if (log && enabled) {
     starttime = get_time();
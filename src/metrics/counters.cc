@@ -0,0 +1,76 @@
+#include <sstream>
+#include <iomanip>
+
+#include <unistd.h>
+
+#include "counters.hh"
+
+#ifdef NBAUTILS_COUNTERS
+std::atomic<uint64_t> counter_values[static_cast<int>(Counter::num)] = {};
+#endif
+
+namespace {
+
+int progress_fd = -1;
+std::shared_ptr<spdlog::logger> progress_log = nullptr;
+double progress_interval = 1.0;
+
+}  // namespace
+
+char const* counter_name(Counter c) {
+  switch (c) {
+    case Counter::succ_computed: return "succ_computed";
+    case Counter::powersucc: return "powersucc";
+    case Counter::bimap_hit: return "bimap_hit";
+    case Counter::bimap_miss: return "bimap_miss";
+    case Counter::trie_tried: return "trie_tried";
+    case Counter::trie_accepted: return "trie_accepted";
+    case Counter::hitset_rounds: return "hitset_rounds";
+    case Counter::edges_redirected: return "edges_redirected";
+    case Counter::num: break;
+  }
+  return "?";
+}
+
+void set_progress_fd(int fd) { progress_fd = fd; }
+void set_progress_log(std::shared_ptr<spdlog::logger> log) { progress_log = log; }
+void set_progress_interval(double secs) { progress_interval = secs; }
+
+Progress::Progress(std::string const& phase)
+  : name(phase), enabled(progress_fd >= 0 || progress_log), start(get_time()), last(start) {}
+
+Progress::~Progress() {
+  if (enabled)
+    snapshot(true);
+}
+
+void Progress::check() {
+  if (duration_to_sec(get_time() - last) >= progress_interval)
+    snapshot();
+}
+
+void Progress::snapshot(bool final) {
+  last = get_time();
+  double const secs = duration_to_sec(last - start);
+  double const div = secs > 0 ? secs : 1;
+
+  std::stringstream ss;
+  ss << std::fixed << std::setprecision(3)
+     << "{\"phase\": \"" << name << "\", \"final\": " << (final ? "true" : "false")
+     << ", \"secs\": " << secs << ", \"states\": " << states << ", \"edges\": " << edges
+     << ", \"states_per_sec\": " << states / div << ", \"edges_per_sec\": " << edges / div;
+#ifdef NBAUTILS_COUNTERS
+  for (int i = 0; i < static_cast<int>(Counter::num); i++)
+    ss << ", \"" << counter_name(static_cast<Counter>(i)) << "\": " << counter_values[i].load(std::memory_order_relaxed);
+#endif
+  ss << "}";
+
+  if (progress_log)
+    progress_log->info("progress: {}", ss.str());
+  if (progress_fd >= 0) {
+    ss << "\n";
+    std::string const line = ss.str();
+    if (write(progress_fd, line.data(), line.size()) < 0)
+      progress_fd = -1; //reader is gone, stop reporting
+  }
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <memory>
+
+#include <spdlog/spdlog.h>
+
+#include "profiler.hh"
+
+//hot-path event counters. they are only compiled in when NBAUTILS_COUNTERS is defined
+//(cmake -Dnbautils-counters=ON), otherwise COUNT(...) expands to nothing.
+//they are atomic, as some explorations compute successors in several threads.
+//
+//explorations (e.g. determinize) report visited states and edges to a Progress object,
+//which periodically emits snapshots (rates and current counter values) as JSON lines
+//to a file descriptor and/or the log. without configured destination this is a no-op.
+
+enum class Counter : int {
+  succ_computed,     //DetState successor calculations
+  powersucc,         //powerset successor calculations
+  bimap_hit,         //put_or_get found existing tag
+  bimap_miss,        //put_or_get inserted new tag
+  trie_tried,        //candidates checked in trie search for existing successor
+  trie_accepted,     //candidates suitable as successor
+  hitset_rounds,     //rounds of hitset refinement
+  edges_redirected,  //edges moved to other successor by hitset optimization
+  num
+};
+
+char const* counter_name(Counter c);
+
+#ifdef NBAUTILS_COUNTERS
+extern std::atomic<uint64_t> counter_values[static_cast<int>(Counter::num)];
+#define COUNT(c) (counter_values[static_cast<int>(Counter::c)].fetch_add(1, std::memory_order_relaxed))
+#define COUNT_N(c, n) (counter_values[static_cast<int>(Counter::c)].fetch_add((n), std::memory_order_relaxed))
+#else
+#define COUNT(c) ((void)0)
+#define COUNT_N(c, n) ((void)0)
+#endif
+
+//where snapshots go (fd<0 and no logger = disabled)
+void set_progress_fd(int fd);
+void set_progress_log(std::shared_ptr<spdlog::logger> log);
+void set_progress_interval(double secs);
+
+//progress of one exploration, snapshot on every interval and at the end
+class Progress {
+  std::string name;
+  bool enabled;
+  timepoint_t start;
+  timepoint_t last;
+  uint64_t states = 0;
+  uint64_t edges = 0;
+
+  void check();
+
+public:
+  explicit Progress(std::string const& phase);
+  ~Progress();
+
+  void add_state() {
+    ++states;
+    if (enabled && (states & 1023) == 0) //check time not too often
+      check();
+  }
+  void add_edge() { ++edges; }
+
+  void snapshot(bool final=false);
+};
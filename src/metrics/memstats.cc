@@ -0,0 +1,131 @@
+#include <atomic>
+#include <cstdlib>
+#include <cstddef>
+#include <new>
+#include <iomanip>
+
+#include "memusage.h"
+#include "memstats.hh"
+
+namespace {
+
+//updated concurrently by allocating threads
+struct SharedMemSysStats {
+  std::atomic<uint64_t> bytes{0};
+  std::atomic<uint64_t> peak{0};
+  std::atomic<uint64_t> allocs{0};
+};
+
+SharedMemSysStats memsys_stats[static_cast<int>(MemSys::num)];
+std::atomic<uint64_t> total_bytes{0};
+std::atomic<uint64_t> total_count{0};
+
+auto const relaxed = std::memory_order_relaxed;
+
+}  // namespace
+
+char const* memsys_name(MemSys s) {
+  switch (s) {
+    case MemSys::other: return "other";
+    case MemSys::tags: return "tags";
+    case MemSys::trie: return "trie";
+    case MemSys::adjacency: return "adjacency";
+    case MemSys::detstate: return "detstate";
+    case MemSys::num: break;
+  }
+  return "?";
+}
+
+#ifdef NBAUTILS_ALLOC_STATS
+
+thread_local MemSys current_memsys = MemSys::other;
+
+namespace {
+
+//every block is prefixed by its size and subsystem (keeping max alignment)
+struct alignas(alignof(std::max_align_t)) BlockHeader {
+  size_t size;
+  MemSys sys;
+};
+
+void* counting_alloc(size_t sz) {
+  auto* h = static_cast<BlockHeader*>(std::malloc(sizeof(BlockHeader) + sz));
+  if (!h)
+    return nullptr;
+  h->size = sz;
+  h->sys = current_memsys;
+
+  auto& st = memsys_stats[static_cast<int>(h->sys)];
+  uint64_t const now = st.bytes.fetch_add(sz, relaxed) + sz;
+  st.allocs.fetch_add(1, relaxed);
+  uint64_t peak = st.peak.load(relaxed);
+  while (now > peak && !st.peak.compare_exchange_weak(peak, now, relaxed)) {}
+  total_bytes.fetch_add(sz, relaxed);
+  total_count.fetch_add(1, relaxed);
+  return h + 1;
+}
+
+void counting_free(void* p) {
+  if (!p)
+    return;
+  auto* h = static_cast<BlockHeader*>(p) - 1;
+  memsys_stats[static_cast<int>(h->sys)].bytes.fetch_sub(h->size, relaxed);
+  std::free(h);
+}
+
+void* counting_new(size_t sz) {
+  void* p = counting_alloc(sz ? sz : 1);
+  if (!p)
+    throw std::bad_alloc();
+  return p;
+}
+
+}  // namespace
+
+void* operator new(size_t sz) { return counting_new(sz); }
+void* operator new[](size_t sz) { return counting_new(sz); }
+void* operator new(size_t sz, std::nothrow_t const&) noexcept { return counting_alloc(sz ? sz : 1); }
+void* operator new[](size_t sz, std::nothrow_t const&) noexcept { return counting_alloc(sz ? sz : 1); }
+void operator delete(void* p) noexcept { counting_free(p); }
+void operator delete[](void* p) noexcept { counting_free(p); }
+void operator delete(void* p, size_t) noexcept { counting_free(p); }
+void operator delete[](void* p, size_t) noexcept { counting_free(p); }
+void operator delete(void* p, std::nothrow_t const&) noexcept { counting_free(p); }
+void operator delete[](void* p, std::nothrow_t const&) noexcept { counting_free(p); }
+
+bool alloc_stats_enabled() { return true; }
+
+#else
+
+bool alloc_stats_enabled() { return false; }
+
+#endif
+
+MemSysStats get_memsys_stats(MemSys s) {
+  auto const& st = memsys_stats[static_cast<int>(s)];
+  MemSysStats ret;
+  ret.bytes = st.bytes.load(relaxed);
+  ret.peak = st.peak.load(relaxed);
+  ret.allocs = st.allocs.load(relaxed);
+  return ret;
+}
+uint64_t alloc_total_bytes() { return total_bytes.load(relaxed); }
+uint64_t alloc_total_count() { return total_count.load(relaxed); }
+
+void print_mem_stats(std::ostream& out) {
+  double const mb = 1024 * 1024;
+  out << std::fixed << std::setprecision(3)
+      << "peak RSS: " << getPeakRSS() / mb << " MB" << std::endl;
+  if (!alloc_stats_enabled())
+    return;
+
+  out << std::left << std::setw(12) << "heap" << std::right
+      << std::setw(14) << "current MB" << std::setw(14) << "peak MB"
+      << std::setw(14) << "#allocs" << std::endl;
+  for (int i = 0; i < static_cast<int>(MemSys::num); i++) {
+    auto const st = get_memsys_stats(static_cast<MemSys>(i));
+    out << std::left << std::setw(12) << memsys_name(static_cast<MemSys>(i)) << std::right
+        << std::setw(14) << st.bytes / mb << std::setw(14) << st.peak / mb
+        << std::setw(14) << st.allocs << std::endl;
+  }
+}
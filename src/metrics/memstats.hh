@@ -0,0 +1,59 @@
+#pragma once
+#include <cstdint>
+#include <ostream>
+
+//optional accounting of heap allocations by subsystem. only compiled in when
+//NBAUTILS_ALLOC_STATS is defined (cmake -Dnbautils-alloc-stats=ON): then global
+//operator new/delete are replaced by counting versions, which attribute each block
+//to the subsystem active when it was allocated. otherwise MEM_SCOPE(...) expands to
+//nothing and all numbers are zero.
+//the numbers are shared by all threads, the active subsystem is per thread.
+//
+//usage:
+//  MEM_SCOPE(trie);  //allocations until end of scope belong to the trie
+
+enum class MemSys : int {
+  other,      //everything not in some scope
+  tags,       //state tag bimaps
+  trie,       //trie of existing states
+  adjacency,  //automaton adjacency maps
+  detstate,   //DetState successor computation
+  num
+};
+
+char const* memsys_name(MemSys s);
+
+struct MemSysStats {
+  uint64_t bytes = 0;  //currently allocated
+  uint64_t peak = 0;   //maximum of currently allocated
+  uint64_t allocs = 0; //number of allocations
+};
+
+bool alloc_stats_enabled();
+MemSysStats get_memsys_stats(MemSys s);
+//sum over all subsystems of allocated bytes and number of allocations since start
+uint64_t alloc_total_bytes();
+uint64_t alloc_total_count();
+
+//peak RSS and (if available) table of subsystems
+void print_mem_stats(std::ostream& out);
+
+#ifdef NBAUTILS_ALLOC_STATS
+extern thread_local MemSys current_memsys;
+
+class MemScope {
+  MemSys prev;
+
+public:
+  explicit MemScope(MemSys s) : prev(current_memsys) { current_memsys = s; }
+  ~MemScope() { current_memsys = prev; }
+  MemScope(MemScope const&) = delete;
+  MemScope& operator=(MemScope const&) = delete;
+};
+
+#define MEM_CONCAT_(a, b) a##b
+#define MEM_CONCAT(a, b) MEM_CONCAT_(a, b)
+#define MEM_SCOPE(s) MemScope MEM_CONCAT(mem_scope_, __LINE__)(MemSys::s)
+#else
+#define MEM_SCOPE(s) ((void)0)
+#endif
@@ -0,0 +1,162 @@
+#include <ctime>
+#include <iomanip>
+
+#include "profiler.hh"
+#include "memusage.h"
+#include "memstats.hh"
+
+namespace {
+
+//escape string for JSON output
+std::string json_str(std::string const& s) {
+  std::string ret = "\"";
+  for (char const c : s) {
+    if (c == '"' || c == '\\')
+      ret += '\\';
+    if (static_cast<unsigned char>(c) < 0x20)
+      ret += ' ';
+    else
+      ret += c;
+  }
+  return ret + "\"";
+}
+
+}  // namespace
+
+double get_cpu_secs() {
+  timespec ts;
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+PhaseStart PhaseStart::now() {
+  PhaseStart ps;
+  ps.rss = getCurrentRSS();
+  ps.peak = getPeakRSS();
+  ps.alloc_bytes = alloc_total_bytes();
+  ps.allocs = alloc_total_count();
+  ps.cpu = get_cpu_secs();
+  ps.wall = get_time();
+  return ps;
+}
+
+Profiler::Profiler() {
+  nodes.push_back(Node{"total", -1, {}});
+}
+
+Profiler& Profiler::get() {
+  static Profiler prof;
+  return prof;
+}
+
+void Profiler::enable(bool trace_events) {
+  enabled = true;
+  tracing = trace_events;
+  origin = get_time();
+}
+
+int Profiler::enter(std::string const& name) {
+  auto it = nodes[cur].children.find(name);
+  int node;
+  if (it != nodes[cur].children.end()) {
+    node = it->second;
+  } else {
+    node = nodes.size();
+    nodes[cur].children[name] = node;
+    nodes.push_back(Node{name, cur, {}});
+  }
+  cur = node;
+  return node;
+}
+
+void Profiler::leave(int node, PhaseStart const& start) {
+  auto const end = get_time();
+  double const wall = duration_to_sec(end - start.wall);
+  Node& n = nodes[node];
+  n.count++;
+  n.wall += wall;
+  n.cpu += get_cpu_secs() - start.cpu;
+  n.rss_delta += static_cast<long>(getCurrentRSS()) - static_cast<long>(start.rss);
+  n.peak_delta += getPeakRSS() - start.peak;
+  n.alloc_bytes += alloc_total_bytes() - start.alloc_bytes;
+  n.allocs += alloc_total_count() - start.allocs;
+  cur = n.parent;
+
+  if (tracing)
+    events.push_back(Event{node, duration_to_sec(start.wall - origin), wall});
+}
+
+void Profiler::write_node(std::ostream& out, int node, int indent) const {
+  Node const& n = nodes[node];
+  std::string const pad(indent, ' ');
+
+  //root has no measurement of its own, sum up its children
+  Node tot = n;
+  if (node == 0) {
+    tot.count = 1;
+    for (auto const& it : n.children) {
+      auto const& c = nodes[it.second];
+      tot.wall += c.wall;
+      tot.cpu += c.cpu;
+      tot.rss_delta += c.rss_delta;
+      tot.peak_delta += c.peak_delta;
+      tot.alloc_bytes += c.alloc_bytes;
+      tot.allocs += c.allocs;
+    }
+  }
+
+  out << pad << "{\"name\": " << json_str(n.name) << ", \"count\": " << tot.count
+      << std::fixed << std::setprecision(6)
+      << ", \"wall\": " << tot.wall << ", \"cpu\": " << tot.cpu
+      << ", \"rss_delta\": " << tot.rss_delta << ", \"peak_delta\": " << tot.peak_delta;
+  if (alloc_stats_enabled())
+    out << ", \"alloc_bytes\": " << tot.alloc_bytes << ", \"allocs\": " << tot.allocs;
+  if (!n.children.empty()) {
+    out << ", \"children\": [\n";
+    size_t i = 0;
+    for (auto const& it : n.children) {
+      write_node(out, it.second, indent+2);
+      out << (++i < n.children.size() ? ",\n" : "\n");
+    }
+    out << pad << "]";
+  }
+  out << "}";
+}
+
+void Profiler::write_json(std::ostream& out) const {
+  write_node(out, 0, 0);
+  out << std::endl;
+}
+
+void Profiler::write_trace(std::ostream& out) const {
+  out << "{\"traceEvents\": [\n" << std::fixed << std::setprecision(3);
+  for (size_t i = 0; i < events.size(); i++) {
+    auto const& ev = events[i];
+    out << "{\"name\": " << json_str(nodes[ev.node].name) << ", \"ph\": \"X\""
+        << ", \"ts\": " << ev.start * 1e6 << ", \"dur\": " << ev.dur * 1e6
+        << ", \"pid\": 0, \"tid\": 0}" << (i+1 < events.size() ? ",\n" : "\n");
+  }
+  out << "], \"displayTimeUnit\": \"ms\"}" << std::endl;
+}
+
+void Profiler::write_summary_node(std::ostream& out, int node, std::string const& path) const {
+  double const mb = 1024 * 1024;
+  for (auto const& it : nodes[node].children) {
+    Node const& n = nodes[it.second];
+    std::string const p = path.empty() ? n.name : path + "/" + n.name;
+    out << p << "\t" << n.count << "\t" << n.wall << "\t" << n.cpu
+        << "\t" << n.rss_delta / mb << "\t" << n.peak_delta / mb;
+    if (alloc_stats_enabled())
+      out << "\t" << n.alloc_bytes / mb << "\t" << n.allocs;
+    out << std::endl;
+    write_summary_node(out, it.second, p);
+  }
+}
+
+void Profiler::write_summary(std::ostream& out) const {
+  out << "phase\t#calls\twall s\tcpu s\tRSS delta MB\tpeak delta MB";
+  if (alloc_stats_enabled())
+    out << "\talloc MB\t#allocs";
+  out << std::endl << std::fixed << std::setprecision(3);
+  write_summary_node(out, 0, "");
+}
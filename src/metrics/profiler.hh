@@ -0,0 +1,124 @@
+#pragma once
+#include <chrono>
+#include <string>
+#include <vector>
+#include <map>
+#include <ostream>
+#include <cstdint>
+
+using timepoint_t = std::chrono::high_resolution_clock::time_point;
+using duration_t = std::chrono::high_resolution_clock::duration;
+
+inline timepoint_t get_time() { return std::chrono::high_resolution_clock::now(); }
+
+inline double duration_to_sec(duration_t const& tp) {
+  return std::chrono::duration_cast<std::chrono::duration<double>>(tp).count();
+}
+
+inline double get_secs_since(timepoint_t const& tp) { return duration_to_sec(get_time() - tp); }
+
+double get_cpu_secs();
+
+//hierarchical phase profiler. phases are opened by scoped objects and nest,
+//so a phase is identified by its path from the root (e.g. process_nba/determinize).
+//for each path the number of calls, the total wall and CPU time and the memory
+//growth (RSS, heap if allocation stats are compiled in, see memstats.hh) are
+//aggregated, so a stream of automata yields one tree. optionally each single call is kept
+//as trace event for chrome://tracing.
+//when the profiler is disabled (default), opening a phase costs one branch.
+//
+//usage:
+//  PROF_PHASE("determinize");   //open phase until end of current scope
+//bench() (see bench.hh) opens a phase as well.
+
+//measurements taken when a phase is opened
+struct PhaseStart {
+  timepoint_t wall;
+  double cpu;
+  size_t rss;
+  size_t peak;
+  uint64_t alloc_bytes;
+  uint64_t allocs;
+
+  static PhaseStart now();
+};
+
+class Profiler {
+  struct Node {
+    std::string name;
+    int parent;
+    std::map<std::string, int> children;
+    size_t count = 0;
+    double wall = 0; //seconds
+    double cpu = 0;  //seconds
+    long rss_delta = 0;     //sum of RSS changes (bytes)
+    size_t peak_delta = 0;  //sum of peak RSS growth (bytes)
+    uint64_t alloc_bytes = 0;
+    uint64_t allocs = 0;
+  };
+
+  struct Event {
+    int node;
+    double start; //seconds since profiler was enabled
+    double dur;
+  };
+
+  bool enabled = false;
+  bool tracing = false;
+  timepoint_t origin;
+
+  std::vector<Node> nodes; //nodes[0] is the root
+  int cur = 0;
+  std::vector<Event> events;
+
+  Profiler();
+
+  void write_node(std::ostream& out, int node, int indent) const;
+  void write_summary_node(std::ostream& out, int node, std::string const& path) const;
+
+public:
+  static Profiler& get(); //process-wide instance
+
+  //start collecting data, with trace_events each single phase call is recorded
+  void enable(bool trace_events=false);
+  bool is_enabled() const { return enabled; }
+
+  //returns node of opened phase
+  int enter(std::string const& name);
+  void leave(int node, PhaseStart const& start);
+
+  //aggregated phase tree as JSON
+  void write_json(std::ostream& out) const;
+  //recorded phase calls in chrome trace event format
+  void write_trace(std::ostream& out) const;
+  //human-readable table of phases
+  void write_summary(std::ostream& out) const;
+};
+
+//RAII guard for a phase
+class ProfPhase {
+  int node = -1;
+  PhaseStart start;
+
+public:
+  explicit ProfPhase(char const* name) {
+    if (Profiler::get().is_enabled())
+      open(name);
+  }
+  ~ProfPhase() {
+    if (node >= 0)
+      Profiler::get().leave(node, start);
+  }
+  ProfPhase(ProfPhase const&) = delete;
+  ProfPhase& operator=(ProfPhase const&) = delete;
+
+private:
+  void open(char const* name) {
+    node = Profiler::get().enter(name);
+    start = PhaseStart::now();
+  }
+};
+
+#define PROF_CONCAT_(a, b) a##b
+#define PROF_CONCAT(a, b) PROF_CONCAT_(a, b)
+#define PROF_PHASE(name) ProfPhase PROF_CONCAT(prof_phase_, __LINE__)(name)
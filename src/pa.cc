@@ -1,41 +1,32 @@
 #include "pa.hh"
 #include <vector>
 #include <string>
-
-std::ostream& operator<<(std::ostream& os, nbautils::PAProdState const& s) {
-  os << "(" << s.a << "," << s.b << ") | ";
-  for (int i=0; i<(int)s.priord.size(); i++) {
-    os << "(" << (s.priord[i].first ? "r" : "l") << "," << s.priord[i].second << ")";
-    if (i!=(int)s.priord.size()-1)
-      os << ",";
-  }
-  return os;
-}
+#include <algorithm>
 
 namespace nbautils {
 using namespace std;
 using namespace nbautils;
 
-bool PAProdState::operator==(PAProdState const& other) const {
-  return a==other.a && b==other.b && priord==other.priord;
+bool PAProdSides::operator==(PAProdSides const& other) const {
+  return low == other.low && high == other.high;
 }
 
-//compare lexicographically
-bool PAProdState::operator<(PAProdState const& other) const {
-  if (a == other.a) {
-    if (b == other.b) {
-        return priord < other.priord;
-    }
-    return b < other.b;
-  }
-  return a < other.a;
+bool PAProdSides::operator<(PAProdSides const& other) const {
+  if (high != other.high)
+    return high < other.high;
+  return low < other.low;
 }
 
-PAProdState::PAProdState() {}
+std::ostream& operator<<(std::ostream& os, PAProdState const& s) {
+  os << "(" << s.a << "," << s.b << ") | " << hex;
+  for (unsigned w = s.sides.num_words(); w-- > 0;)
+    os << s.sides.word(w) << (w ? ":" : "");
+  os << dec;
+  return os;
+}
 
-// construct an initial parity product state from initial state and parity bounds
 // assuming min even parity!
-PAProdState::PAProdState(state_t l, int lmin, int lmax, state_t r, int rmin, int rmax) : a(l), b(r) {
+PAProdConf::PAProdConf(int lmin, int lmax, int rmin, int rmax) {
   if (lmin%2==1)
     ++lmin;
   if (lmax%2==1)
@@ -45,60 +36,99 @@ PAProdState::PAProdState(state_t l, int lmin, int lmax, state_t r, int rmin, int
   if (rmax%2==1)
     ++rmax;
 
-  for (int i=lmin; i<=lmax; i+=2) {
-    priord.push_back(make_pair(false, i));
-  }
-  for (int i=rmin; i<=rmax; i+=2) {
-    priord.push_back(make_pair(true, i));
-  }
+  this->lmin = lmin;
+  this->rmin = rmin;
+  nl = (lmax - lmin) / 2 + 1;
+  nr = (rmax - rmin) / 2 + 1;
 }
 
-PAProdState::PAProdState(PAProdState const& other) : a(other.a), b(other.b), priord(other.priord) {}
+template<typename Sides>
+PAProdStateT<Sides> PAProdConf::initial(state_t l, state_t r) const {
+  PAProdStateT<Sides> s;
+  s.a = l;
+  s.b = r;
+  s.sides = Sides(nl + nr);
+  s.sides.assign(nl, nl + nr, true);
+  return s;
+}
 
 // get new state from current with given new component states (and their prio) and adapted priorities
-pair<PAProdState,int> PAProdState::succ(state_t l, int pl, state_t r, int pr, bool fulldown) const {
-  PAProdState s(*this);
-  int prio;
+template<typename Sides>
+pair<PAProdStateT<Sides>,int> PAProdConf::succ(PAProdStateT<Sides> const& cur, state_t l, int pl, state_t r, int pr,
+                                               bool fulldown) const {
+  PAProdStateT<Sides> s(cur);
 
   //update state pair
   s.a = l;
   s.b = r;
 
-  auto it = s.priord.begin();
-  int i=0;
-  while (it != s.priord.end()) {
-    int p = it->first ? pr : pl;
-    if (it->second == p) { //good priority fires -> we're done
-      prio = 2*(i+1); //fire good
-      break;
-    } else if (it->second-1 == p) { //bad priority fires -> need shifting stuff
-      prio = 2*i+1;  // fire bad
+  unsigned const k = nl + nr;
+  int seen[2] = {0, 0}; //passed priorities of left and right
+  for (unsigned i = 0; i < k; i++) {
+    bool const side = s.sides.test(i);
+    int const itpri = (side ? rmin : lmin) + 2 * seen[side]++;
+    int const p = side ? pr : pl;
 
+    if (itpri == p) //good priority fires -> we're done
+      return make_pair(s, 2*(i+1)); //fire good
+
+    if (itpri-1 == p) { //bad priority fires -> need shifting stuff
       //reshuffle priority tuples (preserving relative order)
 
       //mode: move completely down (looks like better choice)
-      auto it2 = s.priord.end();
+      unsigned end = k;
       if (!fulldown) {
       //mode: move one pair of other automaton above the red one
-        it2 = it;
-        while (it2 != s.priord.end() && it2->first == it->first)
-          ++it2;
-        if (it2 != s.priord.end())
-          ++it2;
+        end = i;
+        while (end < k && s.sides.test(end) == side)
+          ++end;
+        if (end < k)
+          ++end;
       }
 
-      //perform the corresponding shifting
-      stable_partition(it, it2, [b=it->first](auto t){ return t.first != b; });
+      //perform the corresponding shifting: other side first, then this side
+      unsigned const num = s.sides.count(i, end);
+      unsigned const numside = side ? num : (end - i) - num;
+      unsigned const split = end - numside;
+      s.sides.assign(i, split, !side);
+      s.sides.assign(split, end, side);
 
-      break;
+      return make_pair(s, 2*i+1); // fire bad
     }
+  }
+
+  assert(false); //some priority always fires
+  return make_pair(s, -1);
+}
 
-    //nothing interesting happened so just go on
-    ++it;
-    ++i;
+template<typename Sides>
+vector<pair<bool,int>> PAProdConf::priord(PAProdStateT<Sides> const& s) const {
+  vector<pair<bool,int>> ret;
+  int seen[2] = {0, 0};
+  for (unsigned i = 0; i < nl + nr; i++) {
+    bool const side = s.sides.test(i);
+    ret.push_back(make_pair(side, (side ? rmin : lmin) + 2 * seen[side]++));
   }
+  return ret;
+}
 
-  return make_pair(s,prio);
+void PAProdConf::print(ostream& os, PAProdState const& s) const {
+  os << "(" << s.a << "," << s.b << ") | ";
+  auto const ord = priord(s);
+  for (int i=0; i<(int)ord.size(); i++) {
+    os << "(" << (ord[i].first ? "r" : "l") << "," << ord[i].second << ")";
+    if (i!=(int)ord.size()-1)
+      os << ",";
+  }
 }
 
+template PAProdStateT<PAProdSidesInline> PAProdConf::initial(state_t, state_t) const;
+template PAProdStateT<PAProdSides> PAProdConf::initial(state_t, state_t) const;
+template pair<PAProdStateT<PAProdSidesInline>,int> PAProdConf::succ(
+    PAProdStateT<PAProdSidesInline> const&, state_t, int, state_t, int, bool) const;
+template pair<PAProdStateT<PAProdSides>,int> PAProdConf::succ(
+    PAProdStateT<PAProdSides> const&, state_t, int, state_t, int, bool) const;
+template vector<pair<bool,int>> PAProdConf::priord(PAProdStateT<PAProdSidesInline> const&) const;
+template vector<pair<bool,int>> PAProdConf::priord(PAProdStateT<PAProdSides> const&) const;
+
 }
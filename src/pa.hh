@@ -2,7 +2,10 @@
 
 #include <vector>
 #include <cassert>
+#include <cstdint>
+#include <limits>
 #include <functional>
+#include <type_traits>
 #include <unordered_map>
 #include "aut.hh"
 #include "graph.hh"
@@ -10,6 +13,7 @@
 #include "common/util.hh"
 #include "common/parity.hh"
 #include "common/part_refinement.hh"
+#include "paview.hh"
 
 #include <spdlog/spdlog.h>
 
@@ -45,43 +49,159 @@ void change_patype(Aut<T> &aut, PAType pt) {
 
 using EdgeNode = tuple<state_t, sym_t, state_t, pri_t>;
 
-struct PAProdState {
-  state_t a;
-  state_t b;
+//bits lo..hi-1 set (0 <= lo <= hi <= 64)
+inline uint64_t bit_range(unsigned lo, unsigned hi) {
+  uint64_t const upto = hi >= 64 ? ~uint64_t(0) : (uint64_t(1) << hi) - 1;
+  return upto & ~((uint64_t(1) << lo) - 1);
+}
 
-  //representation of <bool = original automaton (false = left, true = right), important bad, less important good neighbor = int>
-  vector<pair<bool,int>> priord;
+// number of set bits in lo..hi-1 of a bit set providing word(w)
+template<typename S>
+unsigned count_bits(S const& s, unsigned lo, unsigned hi) {
+  unsigned ret = 0;
+  for (unsigned w = lo / 64; w * 64 < hi; w++)
+    ret += __builtin_popcountll(s.word(w) & bit_range(max(lo, w*64) - w*64, min(hi, w*64+64) - w*64));
+  return ret;
+}
 
+// set bits lo..hi-1 of a bit set providing word(w) to val
+template<typename S>
+void assign_bits(S& s, unsigned lo, unsigned hi, bool val) {
+  for (unsigned w = lo / 64; w * 64 < hi; w++) {
+    uint64_t const range = bit_range(max(lo, w*64) - w*64, min(hi, w*64+64) - w*64);
+    if (val)
+      s.word(w) |= range;
+    else
+      s.word(w) &= ~range;
+  }
+}
 
-  // construct an initial parity product state from initial state and parity bounds
-  PAProdState(state_t l, int lmin, int lmax, state_t r, int rmin, int rmax);
-  PAProdState(PAProdState const& other);
-  PAProdState();
+// bit set of fixed size with all W words inline, so that it is trivially copyable.
+// used by pa_union whenever the priorities of the product fit
+template<unsigned W>
+class PAProdSidesFixed {
+  uint64_t words[W] = {};
 
-  // get new state from current with given new component states (and their prio) and adapted priorities
-  pair<PAProdState, int> succ(state_t l, int pl, state_t r, int pr, bool fulldown=true) const;
+public:
+  static constexpr unsigned max_bits = 64 * W;
+
+  explicit PAProdSidesFixed(unsigned = 0) {}
+
+  uint64_t word(unsigned w) const { return words[w]; }
+  uint64_t& word(unsigned w) { return words[w]; }
+  unsigned num_words() const { return W; }
+
+  bool test(unsigned i) const { return (words[i / 64] >> (i % 64)) & 1; }
+  unsigned count(unsigned lo, unsigned hi) const { return count_bits(*this, lo, hi); }
+  void assign(unsigned lo, unsigned hi, bool val) { assign_bits(*this, lo, hi, val); }
+
+  bool operator==(PAProdSidesFixed const& other) const {
+    return equal(words, words + W, other.words);
+  }
+  bool operator<(PAProdSidesFixed const& other) const { //most significant word first
+    for (unsigned w = W; w-- > 0;)
+      if (words[w] != other.words[w])
+        return words[w] < other.words[w];
+    return false;
+  }
+};
+using PAProdSidesInline = PAProdSidesFixed<2>;
+
+// bit set of any fixed size. the first 64 bits are stored inline,
+// further words are only allocated for larger sizes
+class PAProdSides {
+  uint64_t low = 0;
+  vector<uint64_t> high;
+
+public:
+  explicit PAProdSides(unsigned bits = 0) : high(bits > 64 ? (bits - 1) / 64 : 0, 0) {}
+  // copy of the first bits of another bit set
+  template<typename S>
+  PAProdSides(S const& other, unsigned bits) : PAProdSides(bits) {
+    for (unsigned w = 0; w < num_words(); w++)
+      word(w) = other.word(w);
+  }
+
+  uint64_t word(unsigned w) const { return w ? high[w-1] : low; }
+  uint64_t& word(unsigned w) { return w ? high[w-1] : low; }
+  unsigned num_words() const { return high.size() + 1; }
+
+  bool test(unsigned i) const { return (word(i / 64) >> (i % 64)) & 1; }
+  unsigned count(unsigned lo, unsigned hi) const { return count_bits(*this, lo, hi); }
+  void assign(unsigned lo, unsigned hi, bool val) { assign_bits(*this, lo, hi, val); }
+
+  bool operator<(PAProdSides const& other) const;
+  bool operator==(PAProdSides const& other) const;
+};
+
+// state of a parity product: the two component states and an ordering of their
+// good (even) priorities, with the bad (odd) neighbor of each one directly above it.
+// the priorities of each component always stay in ascending order, so the ordering
+// is determined by which component is at each position (bit i of sides, 1 = right)
+template<typename Sides>
+struct PAProdStateT {
+  state_t a = 0;
+  state_t b = 0;
+  Sides sides;
+
+  bool operator==(PAProdStateT const& other) const {
+    return a==other.a && b==other.b && sides==other.sides;
+  }
+  //compare lexicographically
+  bool operator<(PAProdStateT const& other) const {
+    if (a != other.a)
+      return a < other.a;
+    if (b != other.b)
+      return b < other.b;
+    return sides < other.sides;
+  }
+};
+static_assert(is_trivially_copyable<PAProdStateT<PAProdSidesInline>>::value, "inline states must stay plain data");
+// general form, used as tag of product states
+using PAProdState = PAProdStateT<PAProdSides>;
+std::ostream& operator<<(std::ostream& os, PAProdState const& s);
+
+// priority ranges of the two components of a parity product (assuming min even parity!)
+// the state operations are instantiated for PAProdSidesInline and PAProdSides
+struct PAProdConf {
+  int lmin = 0;    //smallest even priority of left
+  int rmin = 0;    //smallest even priority of right
+  unsigned nl = 0; //number of even priorities of left
+  unsigned nr = 0; //number of even priorities of right
+
+  // from the priority bounds of the components
+  PAProdConf(int lmin, int lmax, int rmin, int rmax);
+
+  // initial ordering has all priorities of left before right
+  template<typename Sides>
+  PAProdStateT<Sides> initial(state_t l, state_t r) const;
 
-  bool operator<(PAProdState const& other) const;
-  bool operator==(PAProdState const& other) const;
+  // get new state from current with given new component states (and their prio) and adapted priorities
+  template<typename Sides>
+  pair<PAProdStateT<Sides>, int> succ(PAProdStateT<Sides> const& s, state_t l, int pl, state_t r, int pr,
+                                      bool fulldown=true) const;
+
+  // representation of <bool = original automaton (false = left, true = right), important bad, less important good neighbor = int>
+  template<typename Sides>
+  vector<pair<bool,int>> priord(PAProdStateT<Sides> const& s) const;
+  void print(ostream& out, PAProdState const& s) const;
 };
-std::ostream& operator<<(std::ostream& os, PAProdState const& dc);
 }
 
 namespace std {
 using namespace nbautils;
 
-template <>
-struct hash<PAProdState> {
-  size_t operator()(PAProdState const& k) const {
-    // Compute individual hash values for first, second and third
-    // http://stackoverflow.com/a/1646913/126995
-    size_t res = 17;
-    res = res * 31 + hash<state_t>()( k.a );
-    res = res * 31 + hash<state_t>()( k.b );
-    for (auto const& it : k.priord) {
-      res = res * 31 + (hash<int>()( it.second << it.first ));
+template <typename Sides>
+struct hash<PAProdStateT<Sides>> {
+  size_t operator()(PAProdStateT<Sides> const& k) const {
+    uint64_t h = (uint64_t(k.a) << 32 | k.b) * 0x9e3779b97f4a7c15ULL;
+    for (unsigned w = 0; w < k.sides.num_words(); w++) {
+      h ^= h >> 32;
+      h ^= k.sides.word(w);
+      h *= 0xff51afd7ed558ccdULL;
     }
-    return res;
+    h ^= h >> 32;
+    return h;
   }
 };
 
@@ -133,8 +253,9 @@ Aut<T> new_empty_pa(vector<string> const& aps) {
 //assumes that all states are reachable
 //returns accepting (sub)scc from which a run can be easily constructed
 //returns an edge with a good priority to build a run from
-template<typename T, typename F>
-pair<vector<state_t>,EdgeNode> find_acc_pa_scc_ext(Aut<T> const& aut, F extra_predicate) {
+//(works on Aut and PAView)
+template<typename A, typename F>
+pair<vector<state_t>,EdgeNode> find_acc_pa_scc_ext(A const& aut, F extra_predicate) {
   assert(!aut.is_sba());
 
   auto const stronger = stronger_op_f(aut.get_patype());
@@ -200,14 +321,14 @@ pair<vector<state_t>,EdgeNode> find_acc_pa_scc_ext(Aut<T> const& aut, F extra_pr
   return {};
 }
 
-template<typename T>
-pair<vector<state_t>,EdgeNode> find_acc_pa_scc(Aut<T> const& aut) {
+template<typename A>
+pair<vector<state_t>,EdgeNode> find_acc_pa_scc(A const& aut) {
   return find_acc_pa_scc_ext(aut, const_true);
 }
 
 //empty := no accepting subscc
-template<typename T>
-bool pa_is_empty(Aut<T> const& aut) {
+template<typename A>
+bool pa_is_empty(A const& aut) {
   return find_acc_pa_scc(aut).first.empty();
 }
 
@@ -235,39 +356,67 @@ pair<vector<state_t>,vector<state_t>> get_acc_pa_run(Aut<T> const& aut) {
 
 using PAP = Aut<PAProdState>;
 
-//TODO: same topo stuff as with determinization, using "raw" product as base
-template<typename A, typename B>
-PAP pa_union(Aut<A> const& aut_a, Aut<B> const& aut_b) {
-  assert(aut_a.get_patype() == PAType::MIN_EVEN);
-  assert(aut_b.get_patype() == PAType::MIN_EVEN);
-  assert(aut_a.get_aps() == aut_b.get_aps());
-  assert(aut_a.is_colored());
-  assert(aut_b.is_colored());
-  assert(aut_a.is_deterministic());
-  assert(aut_b.is_deterministic());
-  assert(!aut_a.is_sba());
-  assert(!aut_b.is_sba());
+// open addressing table of product states, numbered in insertion order
+template<typename State>
+class PAProdTable {
+  static constexpr state_t empty_slot = numeric_limits<state_t>::max();
+
+  vector<State> states;
+  vector<state_t> slots; // hash -> state id
+
+  void index(state_t s) {
+    size_t const mask = slots.size() - 1;
+    size_t i = hash<State>()(states[s]) & mask;
+    while (slots[i] != empty_slot)
+      i = (i + 1) & mask;
+    slots[i] = s;
+  }
+
+public:
+  PAProdTable() : slots(64, empty_slot) {}
+
+  size_t size() const { return states.size(); }
+  State const& get(state_t s) const { return states[s]; }
+
+  // returns id of the state and whether it was added
+  pair<state_t, bool> put_or_get(State const& ps) {
+    size_t const mask = slots.size() - 1;
+    for (size_t i = hash<State>()(ps) & mask; slots[i] != empty_slot; i = (i + 1) & mask)
+      if (states[slots[i]] == ps)
+        return make_pair(slots[i], false);
+
+    state_t const s = size();
+    states.push_back(ps);
+    if (2 * size() > slots.size()) { //keep load factor below 1/2
+      slots.assign(2 * slots.size(), empty_slot);
+      for (state_t t = 0; t < size(); t++)
+        index(t);
+    } else {
+      index(s);
+    }
+    return make_pair(s, true);
+  }
+};
 
+//TODO: same topo stuff as with determinization, using "raw" product as base
+//(works on Aut and PAView)
+//the product states are only kept in a table during the construction, with their
+//ordering stored as given by Sides. the result gets them as tags (of the general
+//form) unless with_tags is false, for users that only need the graph
+template<typename Sides, typename A, typename B>
+PAP pa_union_with(A const& aut_a, B const& aut_b, PAProdConf const& conf, bool with_tags) {
   state_t const myinit = 0;
   auto pa = Aut<PAProdState>(false, "PA Product (unnamed)", aut_a.get_aps(), myinit);
   pa.set_patype(PAType::MIN_EVEN);
-  pa.tag_to_str = default_printer<PAProdState>();
-
-  state_t const l    = aut_a.get_init();
-  int const lmin = aut_a.pri_bounds().first;
-  int const lmax = aut_a.pri_bounds().second;
+  pa.tag_to_str = [conf](ostream& out, PAProdState const& t){ conf.print(out, t); };
 
-  state_t const r    = aut_b.get_init();
-  int const rmin = aut_b.pri_bounds().first;
-  int const rmax = aut_b.pri_bounds().second;
-
-  PAProdState const inittag(l, lmin, lmax, r, rmin, rmax);
-  pa.tag.put(inittag, myinit);
+  PAProdTable<PAProdStateT<Sides>> prodst;
+  prodst.put_or_get(conf.initial<Sides>(aut_a.get_init(), aut_b.get_init()));
 
   // int numvis=0;
   bfs(myinit, [&](auto const& st, auto const& visit, auto const&) {
     // get inner states of current state
-    auto const curst = pa.tag.geti(st);
+    auto const curst = prodst.get(st);
 
     // ++numvis;
     // if (numvis % 100 == 0) //progress indicator
@@ -280,16 +429,17 @@ PAP pa_union(Aut<A> const& aut_a, Aut<B> const& aut_b) {
     for (auto const i : syms) {
       for (auto const ea : aut_a.succ_edges(curst.a,i))
       for (auto const eb : aut_b.succ_edges(curst.b,i)) {
-        auto const tmp = curst.succ(ea.first, ea.second,
-                                    eb.first, eb.second);
+        auto const tmp = conf.succ(curst, ea.first, ea.second,
+                                   eb.first, eb.second);
         auto const& sucprod = tmp.first;
         auto const prio = tmp.second;
 
         //check whether there is already a state in the graph with this label
-        auto const sucst = pa.tag.put_or_get(sucprod, pa.num_states());
+        auto const suc = prodst.put_or_get(sucprod);
+        auto const sucst = suc.first;
 
         //if this is a new successor, add it to graph and enqueue it:
-        if (!pa.has_state(sucst))
+        if (suc.second)
           pa.add_state(sucst);
         // create edge
         pa.add_edge(st, i, sucst, prio);
@@ -299,29 +449,47 @@ PAP pa_union(Aut<A> const& aut_a, Aut<B> const& aut_b) {
     }
   });
 
+  if (with_tags) {
+    for (state_t s = 0; s < prodst.size(); s++) {
+      auto const& ps = prodst.get(s);
+      pa.tag.put(PAProdState{ps.a, ps.b, PAProdSides(ps.sides, conf.nl + conf.nr)}, s);
+    }
+  }
+
   return move(pa);
 }
 
-//check language inclusion by emptiness test of corresp. intersection via union
+//the states are stored inline if the priorities fit, otherwise with allocated words
 template<typename A, typename B>
-bool dpa_inclusion(Aut<A> const& a, Aut<B> const& b) {
-  auto aut_a(a);
-  auto aut_b(b);
+PAP pa_union(A const& aut_a, B const& aut_b, bool with_tags=true) {
+  assert(aut_a.get_patype() == PAType::MIN_EVEN);
+  assert(aut_b.get_patype() == PAType::MIN_EVEN);
+  assert(aut_a.get_aps() == aut_b.get_aps());
+  assert(aut_a.is_colored());
+  assert(aut_b.is_colored());
+  assert(aut_a.is_deterministic());
+  assert(aut_b.is_deterministic());
+  assert(!aut_a.is_sba());
+  assert(!aut_b.is_sba());
 
-  aut_a.make_colored();
-  complement_pa(aut_a);
-  if (aut_a.is_sba())
-    aut_a.to_tba();
+  PAProdConf const conf(aut_a.pri_bounds().first, aut_a.pri_bounds().second,
+                        aut_b.pri_bounds().first, aut_b.pri_bounds().second);
+  if (conf.nl + conf.nr <= PAProdSidesInline::max_bits)
+    return pa_union_with<PAProdSidesInline>(aut_a, aut_b, conf, with_tags);
+  return pa_union_with<PAProdSides>(aut_a, aut_b, conf, with_tags);
+}
 
-  aut_b.make_colored();
-  if (aut_b.is_sba())
-    aut_b.to_tba();
+//check language inclusion by emptiness test of corresp. intersection via union
+//(the inputs are only viewed as colored, complete TDPAs, not copied)
+template<typename A, typename B>
+bool dpa_inclusion(Aut<A> const& a, Aut<B> const& b) {
+  auto const aut_a = pa_view(a).colored().completed().complemented();
+  auto const aut_b = pa_view(b).colored().completed();
 
-  auto prodpa = pa_union(aut_a, aut_b);
-  complement_pa(prodpa);
+  auto const prodpa = pa_union(aut_a, aut_b, false);
   // print_aut(prodpa);
 
-  return pa_is_empty(prodpa);
+  return pa_is_empty(pa_view(prodpa).complemented());
 }
 
 template<typename A, typename B>
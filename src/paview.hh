@@ -0,0 +1,196 @@
+#pragma once
+
+#include <algorithm>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "aut.hh"
+#include "common/parity.hh"
+
+namespace nbautils {
+using namespace std;
+
+// read-only view of a parity automaton with some transformations applied on the fly,
+// so that products and emptiness checks can use them without copying the automaton.
+// the view is always transition-based (priorities of a state-based automaton are
+// moved to the outgoing edges) and optionally
+// colored:      missing priorities become a weak bad priority (as make_colored)
+// completed:    missing edges lead to a rejecting sink (as make_complete)
+// complemented: all priorities are incremented (as complement_pa)
+// (applied in this order). it provides the parts of the Aut interface that the
+// product, emptiness and SCC algorithms use, so these accept both.
+// the automaton must outlive its views and must not be modified meanwhile.
+template <typename T>
+class PAView {
+  Aut<T> const* aut;
+  bool colored_ = false;
+  bool completed_ = false;
+  bool complemented_ = false;
+
+  pri_t badpri = 0;  // for missing priorities when colored
+  pri_t rejpri = 1;  // of the sink edges
+  bool needsink = false;
+  state_t sink = 0;
+  map<state_t, pri_t> sinkedge; // the only edge of missing symbols
+  vector<pri_t> pris_;          // all priorities of the view, sorted
+  bool aut_colored = false;
+
+  void update() {
+    auto const patype = aut->get_patype();
+    vector<pri_t> const autpris = aut->pris() | ranges::to_vector;
+    aut_colored = aut->is_colored();
+
+    badpri = autpris.empty() ? 0 : autpris.back();
+    if (good_priority(patype, badpri))
+      badpri++;
+    rejpri = pa_acc_is_even(patype) ? 1 : 0;
+
+    needsink = completed_ && aut->num_syms() > 0 && !aut->is_complete();
+    sink = 0;
+    for (auto const p : aut->states())
+      sink = max(sink, p + 1);
+    sinkedge = {{sink, rejpri}};
+
+    pris_ = autpris;
+    if (colored_ && !aut_colored)
+      pris_.push_back(badpri);
+    if (needsink)
+      pris_.push_back(rejpri);
+    for (auto& p : pris_)
+      p = map_pri(p);
+    sort(begin(pris_), end(pris_));
+    pris_.erase(unique(begin(pris_), end(pris_)), end(pris_));
+  }
+
+  pri_t map_pri(pri_t p) const {
+    if (p < 0 && colored_)
+      p = badpri;
+    if (p >= 0 && complemented_)
+      p++;
+    return p;
+  }
+
+  // priority of an edge from p with given priority in aut (sink edges are not in aut)
+  pri_t edge_pri(state_t p, pri_t epri, bool tosink) const {
+    if (tosink)
+      return map_pri(rejpri);
+    if (aut->is_sba())
+      return map_pri(aut->has_pri(p) ? aut->get_pri(p) : -1);
+    return map_pri(epri);
+  }
+
+public:
+  // edges of a state for a symbol, as pairs (target, priority)
+  class Edges {
+    PAView const* v;
+    state_t p;
+    map<state_t, pri_t> const* es;
+    bool tosink;
+
+  public:
+    class iterator {
+      PAView const* v;
+      state_t p;
+      bool tosink;
+      map<state_t, pri_t>::const_iterator it;
+
+    public:
+      iterator(Edges const& e, map<state_t, pri_t>::const_iterator i)
+        : v(e.v), p(e.p), tosink(e.tosink), it(i) {}
+      pair<state_t, pri_t> operator*() const {
+        return make_pair(it->first, v->edge_pri(p, it->second, tosink));
+      }
+      iterator& operator++() { ++it; return *this; }
+      bool operator==(iterator const& o) const { return it == o.it; }
+      bool operator!=(iterator const& o) const { return it != o.it; }
+    };
+
+    Edges(PAView const* view, state_t st, map<state_t, pri_t> const* edges, bool sinkedges)
+      : v(view), p(st), es(edges), tosink(sinkedges) {}
+
+    iterator begin() const { return iterator(*this, es->cbegin()); }
+    iterator end() const { return iterator(*this, es->cend()); }
+    size_t size() const { return es->size(); }
+    bool empty() const { return es->empty(); }
+  };
+
+  explicit PAView(Aut<T> const& a) : aut(&a) { update(); }
+
+  PAView colored() const { auto v = *this; v.colored_ = true; v.update(); return v; }
+  PAView completed() const { auto v = *this; v.completed_ = true; v.update(); return v; }
+  PAView complemented() const { auto v = *this; v.complemented_ = true; v.update(); return v; }
+
+  string const& get_name() const { return aut->get_name(); }
+  vector<string> const& get_aps() const { return aut->get_aps(); }
+  PAType get_patype() const { return aut->get_patype(); }
+  size_t num_syms() const { return aut->num_syms(); }
+  auto syms() const { return aut->syms(); }
+
+  state_t get_init() const { return aut->get_init(); }
+  bool is_sink(state_t const p) const { return needsink && p == sink; }
+  bool has_state(state_t const p) const { return is_sink(p) || aut->has_state(p); }
+
+  vector<state_t> states() const {
+    vector<state_t> ret = aut->states() | ranges::to_vector;
+    if (needsink)
+      ret.push_back(sink);
+    return ret;
+  }
+  size_t num_states() const { return aut->num_states() + (needsink ? 1 : 0); }
+
+  bool is_sba() const { return false; }
+  bool is_colored() const { return colored_ || aut_colored; }
+  bool is_deterministic() const { return aut->is_deterministic(); }
+
+  vector<pri_t> const& pris() const { return pris_; }
+  pair<pri_t, pri_t> pri_bounds() const {
+    if (pris_.empty())
+      return pa_acc_is_even(get_patype()) ? make_pair(1,1) : make_pair(0,0);
+    return make_pair(pris_.front(), pris_.back());
+  }
+
+  vector<sym_t> state_outsyms(state_t const p) const {
+    vector<sym_t> ret;
+    if (needsink) {
+      for (auto const x : aut->syms())
+        ret.push_back(x);
+    } else {
+      for (auto const x : aut->state_outsyms(p))
+        ret.push_back(x);
+    }
+    return ret;
+  }
+
+  Edges succ_edges(state_t const p, sym_t const x) const {
+    if (is_sink(p))
+      return Edges(this, p, &sinkedge, true);
+    auto const& es = aut->succ_edges(p, x);
+    if (es.empty() && needsink)
+      return Edges(this, p, &sinkedge, true);
+    return Edges(this, p, &es, false);
+  }
+
+  // all successors (independent of symbol)
+  vector<state_t> succ(state_t const p) const {
+    if (is_sink(p))
+      return {sink};
+    auto ret = aut->succ(p);
+    if (needsink) {
+      for (auto const x : aut->syms()) {
+        if (aut->succ_edges(p, x).empty()) {
+          ret.push_back(sink);
+          break;
+        }
+      }
+    }
+    return ret;
+  }
+};
+
+template <typename T>
+PAView<T> pa_view(Aut<T> const& aut) {
+  return PAView<T>(aut);
+}
+
+}  // namespace nbautils
@@ -3,8 +3,12 @@
 
 #include "aut.hh"
 #include "common/scc.hh"
+#include "graph.hh"
 #include "ps.hh"
 
+#include <limits>
+#include <unordered_map>
+
 #include <spdlog/spdlog.h>
 namespace spd = spdlog;
 
@@ -65,37 +69,24 @@ BASccAClass ba_scc_classify_acc(Aut<T> const& aut, SCCDat const& scci) {
   return ret;
 }
 
-template <typename F>
-void mark_dead_sccs(BASccAClass const& sccacl, F const& get_suc_sccs,
-    map<unsigned,bool>& dead, unsigned num) {
-  if (map_has_key(dead, num))  // done already
-    return;
-
-  // std::cout << "scc " << num << std::endl;
-  auto sucsccs = get_suc_sccs(num);
-  // mark children first
-  for (auto sucnum : sucsccs)
-    mark_dead_sccs(sccacl, get_suc_sccs, dead, sucnum);
-
-  // if we are rejecting, assume we're dead
-  bool isdead = sccacl.at(num) == -1;
-  // check children and try to falsify
-  for (auto sucscc : sucsccs)
-    isdead = isdead && dead[sucscc];
-  // if still dead, we're really dead.
-  dead[num] = isdead;
-}
-
-// run dfs that marks dead sccs (assuming trivial SCCs never accepting)
+// dead sccs reach only rejecting sccs (assuming trivial SCCs never accepting)
 template <typename T>
 set<unsigned> ba_get_dead_sccs(Aut<T> const& ba, SCCDat const& scci, BASccAClass const& sccacl) {
-  map<unsigned, bool> dead;
-  auto const scc_succ = [&](unsigned const scc){ return succ_sccs(aut_succ(ba), scci, scc); };
+  ReachIndex const reach(scci, aut_succ(ba));
 
-  for (auto const i : ranges::view::keys(sccacl))
-    mark_dead_sccs(sccacl, scc_succ, dead, i);
+  vector<unsigned> live; //non-rejecting sccs
+  for (auto const& it : sccacl)
+    if (it.second != -1)
+      live.push_back(it.first);
 
-  return mapbool_to_set(dead);
+  set<unsigned> ret;
+  for (auto const i : ranges::view::keys(sccacl)) {
+    bool const dead = none_of(cbegin(live), cend(live),
+        [&](unsigned j){ return reach.scc_reaches(i, j); });
+    if (dead)
+      ret.emplace(i);
+  }
+  return ret;
 }
 
 // return deterministic SCCs (only det. transitions inside, can have nondet to outside)
@@ -397,31 +388,157 @@ auto ba_direct_sim(Aut<T> const& ba) {
 //context state set -> relatively acc, rej subsets
 using Context = unordered_map<nba_bitset, pair<nba_bitset, nba_bitset>>;
 
+// classifies the SCCs of 2^AxA (see powerset_product) without building it.
+// the reachable powersets are explored once, collecting the reachable pointed states
+// of each powerset as bitset. then the SCCs of the product are found by an iterative
+// Tarjan search on the implicit nodes (powerset id, state).
 Context get_context(auto const& aut, adj_mat const& mat, nba_bitset const asinks, map<unsigned, nba_bitset> const& impl,
                     shared_ptr<spdlog::logger> log = nullptr) {
+  assert(aut.is_buchi());
+  unsigned const nsyms = mat.size();
+  unsigned const n = mat.front().size(); //largest state + 1
+  unsigned const none = numeric_limits<unsigned>::max();
+
+  auto const post = [&](nba_bitset const& from, sym_t const x) {
+    nba_bitset ret = 0;
+    for (auto i = from._Find_first(); i < from.size(); i = from._Find_next(i))
+      ret |= mat[x][i];
+    return ret;
+  };
 
-  auto const psp = bench(log,"powerset_product",
-                         WRAP(powerset_product(aut, mat, asinks, impl)));
-  auto const psp_scci = get_sccs(psp.states(), aut_succ(psp));
-  auto const psp_sccAcc = ba_scc_classify_acc(psp, psp_scci);
-  // print_aut(psp);
+  vector<nba_bitset> psets;   //reachable powersets
+  vector<nba_bitset> pointed; //reachable pointed states of each powerset
+  vector<nba_bitset> pending; //pointed states with unexplored successors
+  vector<unsigned> psuc;      //successor powerset of id*nsyms+x
+  unordered_map<nba_bitset, unsigned> psid;
+  auto const get_id = [&](nba_bitset const& s) {
+    auto const it = psid.emplace(s, psets.size());
+    if (it.second) {
+      psets.push_back(s);
+      pointed.push_back(0);
+      pending.push_back(0);
+      psuc.resize(psuc.size() + nsyms, none);
+    }
+    return it.first->second;
+  };
 
-  if (log)
-    log->info("#states in 2^AxA: {}, #SCCs in 2^AxA: {}",
-              psp.num_states(), psp_scci.sccs.size());
+  nba_bitset initset = 0;
+  initset[aut.get_init()] = 1;
+  get_id(initset);
+  pointed[0] = pending[0] = initset;
+  queue<unsigned> bfsq;
+  bfsq.push(0);
+  while (!bfsq.empty()) {
+    auto const p = bfsq.front();
+    bfsq.pop();
+    auto const cur = pending[p];
+    pending[p] = 0;
+
+    for (unsigned x = 0; x < nsyms; x++) { //not sym_t, wraps with 2^16 symbols
+      auto const sucpt = post(cur, x);
+      if (sucpt == 0)
+        continue;
+      if (psuc[size_t(p)*nsyms + x] == none) {
+        auto const sucset = powersucc(mat, psets[p], x, asinks, impl);
+        auto const sucid = get_id(sucset);
+        psuc[size_t(p)*nsyms + x] = sucid;
+      }
 
-  Context ret;
-  for (auto const s : psp.states()) {
-    auto const& t = psp.tag.geti(s);
-    int val = psp_sccAcc.at(psp_scci.scc_of.at(s));
-    if (!map_has_key(ret, t.first))
-      ret[t.first] = {};
-    if (val==1)
-      ret[t.first].first[t.second] = 1;
-    else if (val==-1)
-      ret[t.first].second[t.second] = 1;
+      auto const q = psuc[size_t(p)*nsyms + x];
+      auto const added = sucpt & ~pointed[q];
+      if (added == 0)
+        continue;
+      if (pending[q] == 0)
+        bfsq.push(q);
+      pointed[q] |= added;
+      pending[q] |= added;
+    }
   }
 
+  //tarjan on nodes p*n+q, all successors of q for sym x lead to powerset psuc[p*nsyms+x]
+  struct Frame {
+    size_t v;
+    unsigned x; //not sym_t, wraps with 2^16 symbols
+    nba_bitset rest; //unvisited successor states for sym x
+  };
+  size_t const nnodes = psets.size() * n;
+  vector<unsigned> order(nnodes, none);
+  vector<unsigned> low(nnodes, 0);
+  vector<bool> done(nnodes, false);
+  vector<size_t> open;
+  vector<Frame> call;
+  unsigned count = 0;
+  unsigned numsccs = 0;
+  vector<pair<nba_bitset, nba_bitset>> cls(psets.size());
+
+  auto const discover = [&](size_t const v) {
+    order[v] = low[v] = count++;
+    open.push_back(v);
+    call.push_back({v, 0, mat[0][v % n]});
+  };
+
+  for (unsigned r = 0; r < psets.size(); r++) {
+    for (auto rq = pointed[r]._Find_first(); rq < n; rq = pointed[r]._Find_next(rq)) {
+      if (order[size_t(r)*n + rq] != none)
+        continue;
+      discover(size_t(r)*n + rq);
+
+      while (!call.empty()) {
+        auto& f = call.back();
+        auto const p = f.v / n;
+        auto const q = f.v % n;
+        while (f.rest == 0 && ++f.x < nsyms)
+          f.rest = mat[f.x][q];
+
+        if (f.rest != 0) {
+          auto const sq = f.rest._Find_first();
+          f.rest[sq] = 0;
+          size_t const w = size_t(psuc[p*nsyms + f.x])*n + sq;
+          if (order[w] == none)
+            discover(w);
+          else if (!done[w])
+            low[f.v] = min(low[f.v], order[w]);
+          continue;
+        }
+
+        //all successors visited
+        auto const v = f.v;
+        call.pop_back();
+        if (!call.empty())
+          low[call.back().v] = min(low[call.back().v], low[v]);
+        if (low[v] != order[v])
+          continue;
+
+        //v is root of an SCC, which is on top of the open stack
+        auto start = open.size();
+        do { --start; } while (open[start] != v);
+        bool acc = true;
+        bool rej = true;
+        for (auto i = start; i < open.size(); i++) {
+          if (aut.state_buchi_accepting(open[i] % n))
+            rej = false;
+          else
+            acc = false;
+        }
+        for (auto i = start; i < open.size(); i++) {
+          done[open[i]] = true;
+          if (acc)
+            cls[open[i] / n].first[open[i] % n] = 1;
+          else if (rej)
+            cls[open[i] / n].second[open[i] % n] = 1;
+        }
+        open.resize(start);
+        numsccs++;
+      }
+    }
+  }
+
+  if (log)
+    log->info("#states in 2^AxA: {}, #SCCs in 2^AxA: {}", count, numsccs);
+
+  Context ret;
+  for (unsigned p = 0; p < psets.size(); p++)
+    ret[psets[p]] = cls[p];
   return ret;
 }
 
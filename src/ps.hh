@@ -2,10 +2,14 @@
 
 #include "aut.hh"
 #include "common/util.hh"
+#include "common/scc.hh"
 
+#include <cstdint>
+#include <limits>
 #include <memory>
 #include <queue>
 #include <set>
+#include <utility>
 #include <vector>
 
 namespace nbautils {
@@ -52,6 +56,169 @@ PS powerset_construction(auto const& nba, adj_mat const& mat, nba_bitset const&
   return ps;
 }
 
+// open addressing table of powersets, numbered in insertion order.
+// only the 64 bit words needed for the NBA are stored per set.
+class PSetTable {
+  static constexpr state_t empty_slot = numeric_limits<state_t>::max();
+
+  unsigned words;        // 64 bit words per set
+  vector<uint64_t> data; // set i starts at i*words
+  vector<state_t> slots; // hash -> set id
+
+  uint64_t hash(uint64_t const* w) const {
+    uint64_t h = 0x9e3779b97f4a7c15ULL;
+    for (unsigned i = 0; i < words; i++) {
+      h ^= w[i];
+      h *= 0xff51afd7ed558ccdULL;
+      h ^= h >> 32;
+    }
+    return h;
+  }
+
+  void to_words(nba_bitset const& b, uint64_t* w) const {
+    nba_bitset const mask = numeric_limits<uint64_t>::max();
+    for (unsigned i = 0; i < words; i++)
+      w[i] = ((b >> (64 * i)) & mask).to_ullong();
+  }
+
+  void index(state_t s) {
+    size_t const mask = slots.size() - 1;
+    size_t i = hash(&data[s * words]) & mask;
+    while (slots[i] != empty_slot)
+      i = (i + 1) & mask;
+    slots[i] = s;
+  }
+
+public:
+  // nbastates is the largest NBA state + 1
+  explicit PSetTable(size_t nbastates)
+    : words(max<size_t>(1, (nbastates + 63) / 64)), slots(64, empty_slot) {}
+
+  size_t size() const { return data.size() / words; }
+
+  nba_bitset get(state_t s) const {
+    nba_bitset b = 0;
+    for (unsigned i = 0; i < words; i++)
+      b |= nba_bitset(data[s * words + i]) << (64 * i);
+    return b;
+  }
+
+  // returns id of the set and whether it was added
+  pair<state_t, bool> put_or_get(nba_bitset const& b) {
+    uint64_t w[nba_bitset().size() / 64];
+    to_words(b, w);
+    size_t const mask = slots.size() - 1;
+    for (size_t i = hash(w) & mask; slots[i] != empty_slot; i = (i + 1) & mask)
+      if (equal(w, w + words, &data[slots[i] * words]))
+        return make_pair(slots[i], false);
+
+    state_t const s = size();
+    data.insert(data.end(), w, w + words);
+    if (2 * size() > slots.size()) { //keep load factor below 1/2
+      slots.assign(2 * slots.size(), empty_slot);
+      for (state_t t = 0; t < size(); t++)
+        index(t);
+    } else {
+      index(s);
+    }
+    return make_pair(s, true);
+  }
+};
+
+// powerset construction that computes the SCCs of 2^A while exploring it (Tarjan).
+// states are numbered in DFS discovery order, the initial powerset is 0.
+// on_scc(ps, scci, num) is called with the partial result whenever an SCC is completed
+// (without tags, these are only set at the end from the table of powersets).
+// all successor SCCs are completed before, so bottom SCCs are reported first.
+// if on_scc returns false, the exploration is aborted (the result is partial then).
+template <typename F>
+pair<PS, SCCDat> powerset_construction_sccs(auto const& nba, adj_mat const& mat, nba_bitset const& sinks,
+                                            map<unsigned,nba_bitset> const& impls, F const& on_scc) {
+  assert(nba.is_buchi());
+  unsigned const none = numeric_limits<unsigned>::max();
+
+  state_t const myinit = 0;
+  auto ps = PS(true, nba.get_name(), nba.get_aps(), myinit);
+  ps.tag_to_str = [](ostream& out, ps_tag const& t){ out << pretty_bitset(t); };
+  SCCDat scci;
+
+  PSetTable table(mat.front().size());
+  vector<unsigned> order; // dfs visit order (none = completed)
+  vector<unsigned> low;
+  vector<state_t> open;   // tarjan stack
+  vector<pair<state_t, unsigned>> call; // dfs stack with next symbol to check (sym_t wraps)
+  unsigned count = 0;
+
+  auto const discover = [&](state_t const s) {
+    order.push_back(count);
+    low.push_back(count);
+    count++;
+    open.push_back(s);
+    call.emplace_back(s, 0);
+  };
+
+  nba_bitset initset = 0;
+  initset[nba.get_init()] = 1; // 1<<x does not work as expected
+  table.put_or_get(initset);
+  discover(myinit);
+
+  while (!call.empty()) {
+    auto const st = call.back().first;
+    auto const x = call.back().second;
+
+    if (x < ps.num_syms()) {
+      call.back().second++;
+      auto const sucset = powersucc(mat, table.get(st), x, sinks, impls);
+      if (sucset == 0)
+        continue;
+
+      auto const suc = table.put_or_get(sucset);
+      if (suc.second)
+        ps.add_state(suc.first);
+      ps.add_edge(st, x, suc.first);
+
+      if (suc.second)
+        discover(suc.first);
+      else if (order[suc.first] != none)
+        low[st] = min(low[st], order[suc.first]);
+      continue;
+    }
+
+    // all successors done
+    call.pop_back();
+    if (!call.empty())
+      low[call.back().first] = min(low[call.back().first], low[st]);
+    if (low[st] != order[st])
+      continue;
+
+    // st is root of an SCC on top of the open stack
+    unsigned const curnum = scci.sccs.size();
+    auto& sccsts = scci.sccs[curnum];
+    state_t tmp;
+    do {
+      tmp = open.back();
+      open.pop_back();
+      order[tmp] = none;
+      scci.scc_of[tmp] = curnum;
+      sccsts.push_back(tmp);
+    } while (tmp != st);
+    sort(begin(sccsts), end(sccsts));
+
+    bool const go_on = on_scc(as_const(ps), as_const(scci), curnum);
+    if (!go_on)
+      break;
+  }
+
+  for (state_t s = 0; s < table.size(); s++)
+    ps.tag.put(table.get(s), s);
+  return make_pair(move(ps), move(scci));
+}
+
+pair<PS, SCCDat> powerset_construction_sccs(auto const& nba, adj_mat const& mat, nba_bitset const& sinks=0,
+                                            map<unsigned,nba_bitset> const& impls={}) {
+  return powerset_construction_sccs(nba, mat, sinks, impls, [](PS const&, SCCDat const&, unsigned){ return true; });
+}
+
 using pp_tag = pair<nba_bitset, state_t>;
 // 2^AxA for some A
 using PP = Aut<pp_tag>;
@@ -0,0 +1,121 @@
+#include <vector>
+#include <map>
+#include <set>
+#include <stdexcept>
+
+#include "randaut.hh"
+
+namespace nbautils {
+using namespace std;
+
+namespace {
+
+// symbols of a random cube (each AP positive, negative or don't care)
+vector<sym_t> random_cube(RandGen& rng, unsigned aps) {
+  vector<sym_t> ret{0};
+  for (unsigned i = 0; i < aps; i++) {
+    auto const kind = rng.below(3);
+    if (kind == 2) { //don't care
+      size_t const n = ret.size();
+      for (size_t j = 0; j < n; j++)
+        ret.push_back(ret[j] | (1 << i));
+    } else if (kind == 1) {
+      for (auto& x : ret)
+        x |= (1 << i);
+    }
+  }
+  return ret;
+}
+
+}  // namespace
+
+Aut<string> random_nba(RandNBAParams const& p) {
+  if (p.states == 0 || p.states > max_nba_states)
+    throw runtime_error("Number of states must be between 1 and " + to_string(max_nba_states) + "!");
+  if (p.aps > 8 * sizeof(sym_t))
+    throw runtime_error("Too many atomic propositions!");
+  if (p.sccs > p.states)
+    throw runtime_error("More SCCs than states requested!");
+
+  RandGen rng(p.seed);
+  unsigned const n = p.states;
+  sym_t const nsyms = (1 << p.aps) - 1; //largest symbol
+
+  // consecutive blocks of states, block of later states is never smaller
+  auto const block = [&](state_t s) { return p.sccs ? s * p.sccs / n : 0; };
+  auto const allowed = [&](state_t a, state_t b) { return !p.sccs || block(a) <= block(b); };
+
+  vector<map<sym_t, set<state_t>>> out(n);
+  vector<map<sym_t, set<state_t>>> required(n); //edges that must survive
+  vector<bool> det(n);
+  for (state_t s = 0; s < n; s++)
+    det[s] = rng.chance(p.det);
+
+  // required edges get a symbol not yet required from that state, if possible
+  auto const add_required = [&](state_t a, state_t b) {
+    sym_t x = rng.below(nsyms + 1);
+    for (unsigned i = 0; i <= nsyms && map_has_key(required[a], x); i++)
+      x = (x + 1) & nsyms;
+    required[a][x].insert(b);
+    out[a][x].insert(b);
+  };
+
+  // all states reachable: random tree from initial state 0
+  for (state_t s = 1; s < n; s++)
+    add_required(rng.below(s), s);
+
+  // each block strongly connected: cycle through its states
+  if (p.sccs) {
+    state_t first = 0;
+    for (state_t s = 1; s <= n; s++) {
+      if (s < n && block(s) == block(first))
+        continue;
+      if (s - first > 1) //singleton blocks may stay trivial
+        for (state_t t = first; t < s; t++)
+          add_required(t, t + 1 < s ? t + 1 : first);
+      first = s;
+    }
+  }
+
+  // random edges with cube labels
+  for (state_t a = 0; a < n; a++)
+    for (state_t b = 0; b < n; b++)
+      if (allowed(a, b) && rng.chance(p.density))
+        for (auto const x : random_cube(rng, p.aps))
+          out[a][x].insert(b);
+
+  string const name = "random nba (" + to_string(n) + " states, " + to_string(p.aps)
+                      + " aps, seed " + to_string(p.seed) + ")";
+  Aut<string> aut(true, name, {}, 0);
+  vector<string> aps;
+  for (unsigned i = 0; i < p.aps; i++)
+    aps.push_back("p" + to_string(i));
+  aut.set_aps(aps);
+
+  for (state_t s = 1; s < n; s++)
+    aut.add_state(s);
+  for (state_t s = 0; s < n; s++)
+    if (rng.chance(p.acc))
+      aut.set_pri(s, 0);
+
+  for (state_t a = 0; a < n; a++) {
+    for (auto const& it : out[a]) {
+      auto const x = it.first;
+      if (det[a] && map_has_key(required[a], x)) { //keep only required successors
+        for (auto const b : required[a].at(x))
+          aut.add_edge(a, x, b);
+      } else if (det[a]) { //keep one random successor
+        auto sit = it.second.begin();
+        advance(sit, rng.below(it.second.size()));
+        aut.add_edge(a, x, *sit);
+      } else {
+        for (auto const b : it.second)
+          aut.add_edge(a, x, b);
+      }
+    }
+  }
+
+  return aut;
+}
+
+}  // namespace nbautils
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <random>
+
+#include "aut.hh"
+
+// seeded generator of random Büchi automata for stress tests and scaling experiments.
+// only the raw output of mt19937_64 is used (no std distributions), so the same
+// parameters and seed give the same automaton on every platform.
+
+namespace nbautils {
+using namespace std;
+
+struct RandNBAParams {
+  unsigned states = 10;   // number of states (all reachable from initial state 0)
+  unsigned aps = 2;       // number of atomic propositions
+  double density = 0.2;   // probability that a pair of states is connected by an edge
+  double acc = 0.3;       // probability that a state is accepting
+  unsigned sccs = 0;      // if > 0: states are split into this many consecutive blocks,
+                          // each strongly connected, edges only go to same or later blocks
+  double det = 0;         // fraction of states with at most one successor per symbol
+                          // (best effort, edges needed for reachability are kept)
+  uint64_t seed = 0;
+};
+
+class RandGen {
+  mt19937_64 gen;
+
+public:
+  explicit RandGen(uint64_t seed) : gen(seed) {}
+
+  // uniform in [0,n)
+  uint64_t below(uint64_t n) { return gen() % n; }
+  // uniform in [0,1)
+  double uniform() { return (gen() >> 11) * (1.0 / (uint64_t(1) << 53)); }
+  bool chance(double p) { return uniform() < p; }
+};
+
+// throws runtime_error on invalid parameters
+Aut<string> random_nba(RandNBAParams const& p);
+
+}  // namespace nbautils
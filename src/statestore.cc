@@ -0,0 +1,243 @@
+#include <cstring>
+#include <cerrno>
+#include <stdexcept>
+#include <limits>
+#include <algorithm>
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+
+#include "statestore.hh"
+
+namespace nbautils {
+using namespace std;
+
+namespace {
+
+state_t const empty_slot = numeric_limits<state_t>::max();
+size_t const min_log_size = size_t(1) << 26;
+
+void put_u32(vector<uint8_t>& buf, uint32_t v) {
+  auto const p = reinterpret_cast<uint8_t const*>(&v);
+  buf.insert(buf.end(), p, p + sizeof(v));
+}
+
+uint32_t get_u32(uint8_t const*& p) {
+  uint32_t v;
+  memcpy(&v, p, sizeof(v));
+  p += sizeof(v);
+  return v;
+}
+
+void put_bits(vector<uint8_t>& buf, nba_bitset const& b, unsigned words) {
+  nba_bitset const mask = numeric_limits<uint64_t>::max();
+  for (unsigned w = 0; w < words; w++) {
+    uint64_t const word = ((b >> (64 * w)) & mask).to_ullong();
+    auto const p = reinterpret_cast<uint8_t const*>(&word);
+    buf.insert(buf.end(), p, p + sizeof(word));
+  }
+}
+
+nba_bitset get_bits(uint8_t const*& p, unsigned words) {
+  nba_bitset b = 0;
+  for (unsigned w = 0; w < words; w++) {
+    uint64_t word;
+    memcpy(&word, p, sizeof(word));
+    p += sizeof(word);
+    b |= nba_bitset(word) << (64 * w);
+  }
+  return b;
+}
+
+void put_slices(vector<uint8_t>& buf, vector<ranked_slice> const& v, unsigned words) {
+  put_u32(buf, v.size());
+  for (auto const& rs : v) {
+    put_u32(buf, rs.size());
+    for (auto const& it : rs) {
+      put_bits(buf, it.first, words);
+      put_u32(buf, it.second);
+    }
+  }
+}
+
+vector<ranked_slice> get_slices(uint8_t const*& p, unsigned words) {
+  vector<ranked_slice> v(get_u32(p));
+  for (auto& rs : v) {
+    rs.resize(get_u32(p));
+    for (auto& it : rs) {
+      it.first = get_bits(p, words);
+      it.second = static_cast<pri_t>(get_u32(p));
+    }
+  }
+  return v;
+}
+
+}  // namespace
+
+string scratch_file(string const& dir, string const& name) {
+  return dir + "/nbadet-" + to_string(getpid()) + "-" + name;
+}
+
+MappedLog::MappedLog(string const& file) : filename(file) {
+  fd = open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+  if (fd < 0)
+    throw runtime_error("cannot create " + filename + ": " + strerror(errno) + "!");
+  remap(min_log_size);
+}
+
+MappedLog::~MappedLog() {
+  if (data)
+    munmap(data, capacity);
+  if (fd >= 0) {
+    close(fd);
+    unlink(filename.c_str());
+  }
+}
+
+void MappedLog::remap(size_t newcap) {
+  if (data)
+    munmap(data, capacity);
+  data = nullptr;
+  if (ftruncate(fd, newcap) != 0)
+    throw runtime_error("cannot grow " + filename + ": " + strerror(errno) + "!");
+  void* const p = mmap(nullptr, newcap, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (p == MAP_FAILED)
+    throw runtime_error("cannot map " + filename + ": " + strerror(errno) + "!");
+  data = static_cast<uint8_t*>(p);
+  capacity = newcap;
+}
+
+uint64_t MappedLog::append(uint8_t const* bytes, size_t len) {
+  if (used + len > capacity) {
+    size_t newcap = capacity;
+    while (used + len > newcap)
+      newcap *= 2;
+    remap(newcap);
+  }
+  memcpy(data + used, bytes, len);
+  uint64_t const off = used;
+  used += len;
+  return off;
+}
+
+DetStateStore::DetStateStore(string const& dir, size_t nbastates)
+  : words((nbastates + 63) / 64), log(scratch_file(dir, "states.log")),
+    slots(1 << 16, empty_slot) {
+  if (words == 0)
+    words = 1;
+}
+
+size_t DetStateStore::index_bytes() const {
+  return offsets.capacity() * sizeof(uint64_t) + fps.capacity() * sizeof(uint64_t)
+       + slots.capacity() * sizeof(state_t);
+}
+
+void DetStateStore::encode(DetState const& ds, vector<uint8_t>& buf) const {
+  buf.clear();
+  put_bits(buf, ds.powerset, words);
+  put_bits(buf, ds.nsccs, words);
+  put_bits(buf, ds.asccs_buf, words);
+  put_bits(buf, ds.asccs, words);
+  put_u32(buf, ds.asccs_pri);
+  put_slices(buf, ds.dsccs, words);
+  put_slices(buf, ds.msccs, words);
+}
+
+uint64_t DetStateStore::fingerprint(uint8_t const* bytes, size_t len) {
+  uint64_t h = 0x9e3779b97f4a7c15ULL ^ len;
+  auto const mix = [&](uint64_t v) {
+    h ^= v;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 32;
+  };
+  size_t i = 0;
+  for (; i + 8 <= len; i += 8) {
+    uint64_t v;
+    memcpy(&v, bytes + i, sizeof(v));
+    mix(v);
+  }
+  uint64_t rest = 0;
+  memcpy(&rest, bytes + i, len - i);
+  mix(rest);
+  h ^= h >> 29;
+  return h;
+}
+
+DetState DetStateStore::get(state_t s) const {
+  uint8_t const* p = log.at(offsets.at(s));
+  DetState ds;
+  ds.powerset = get_bits(p, words);
+  ds.nsccs = get_bits(p, words);
+  ds.asccs_buf = get_bits(p, words);
+  ds.asccs = get_bits(p, words);
+  ds.asccs_pri = static_cast<pri_t>(get_u32(p));
+  ds.dsccs = get_slices(p, words);
+  ds.msccs = get_slices(p, words);
+  return ds;
+}
+
+size_t DetStateStore::length(state_t s) const {
+  return (s + 1 < offsets.size() ? offsets[s + 1] : log.size()) - offsets[s];
+}
+
+bool DetStateStore::same(state_t s, uint8_t const* bytes, size_t len, uint64_t fp) const {
+  return fps[s] == fp && length(s) == len && memcmp(log.at(offsets[s]), bytes, len) == 0;
+}
+
+void DetStateStore::index(state_t s) {
+  size_t const mask = slots.size() - 1;
+  size_t i = fps[s] & mask;
+  while (slots[i] != empty_slot)
+    i = (i + 1) & mask;
+  slots[i] = s;
+}
+
+state_t DetStateStore::add(uint8_t const* bytes, size_t len, uint64_t fp) {
+  if (size() >= empty_slot)
+    throw runtime_error("too many states for state store!");
+  state_t const s = size();
+  offsets.push_back(log.append(bytes, len));
+  fps.push_back(fp);
+
+  if (2 * size() > slots.size()) { //keep load factor below 1/2
+    slots.assign(2 * slots.size(), empty_slot);
+    for (state_t t = 0; t < size(); t++)
+      index(t);
+  } else {
+    index(s);
+  }
+  return s;
+}
+
+pair<state_t, bool> DetStateStore::put_or_get(uint8_t const* bytes, size_t len, uint64_t fp) {
+  size_t const mask = slots.size() - 1;
+  for (size_t i = fp & mask; slots[i] != empty_slot; i = (i + 1) & mask)
+    if (same(slots[i], bytes, len, fp))
+      return make_pair(slots[i], false);
+  return make_pair(add(bytes, len, fp), true);
+}
+
+vector<state_t> DetStateStore::put_or_get_all(uint8_t const* bytes, vector<StoreQuery> const& qs) {
+  //(stored state, query) with same fingerprint and length
+  vector<pair<state_t, size_t>> cands;
+  size_t const mask = slots.size() - 1;
+  for (size_t j = 0; j < qs.size(); j++)
+    for (size_t i = qs[j].fp & mask; slots[i] != empty_slot; i = (i + 1) & mask)
+      if (fps[slots[i]] == qs[j].fp && length(slots[i]) == qs[j].len)
+        cands.emplace_back(slots[i], j);
+  sort(begin(cands), end(cands)); //states are in the log in order of their ids
+
+  vector<state_t> ret(qs.size(), empty_slot);
+  for (auto const& it : cands) {
+    StoreQuery const& q = qs[it.second];
+    if (ret[it.second] == empty_slot && memcmp(log.at(offsets[it.first]), bytes + q.off, q.len) == 0)
+      ret[it.second] = it.first;
+  }
+  for (size_t j = 0; j < qs.size(); j++)
+    if (ret[j] == empty_slot)
+      ret[j] = add(bytes + qs[j].off, qs[j].len, qs[j].fp);
+  return ret;
+}
+
+}  // namespace nbautils
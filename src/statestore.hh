@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <utility>
+
+#include "common/types.hh"
+#include "detstate.hh"
+
+// disk-backed storage of determinization states, for DPAs that do not fit into RAM.
+// the states live in an append-only memory mapped log, only a fingerprint index
+// (a few dozen bytes per state) is kept in memory. the operating system decides
+// which parts of the log stay in the page cache.
+
+namespace nbautils {
+using namespace std;
+
+// unique name for a scratch file of this process in dir
+string scratch_file(string const& dir, string const& name);
+
+// scratch file that is removed when it goes out of scope
+struct ScratchFile {
+  string const path;
+  ScratchFile(string const& dir, string const& name) : path(scratch_file(dir, name)) {}
+  ~ScratchFile() { remove(path.c_str()); }
+};
+
+// append-only file that is mapped into memory and grows on demand.
+// pointers returned by at() are invalidated by append().
+// the file is removed on destruction.
+class MappedLog {
+  string filename;
+  int fd = -1;
+  uint8_t* data = nullptr;
+  size_t used = 0;
+  size_t capacity = 0;
+
+  void remap(size_t newcap);
+
+public:
+  explicit MappedLog(string const& file);
+  ~MappedLog();
+  MappedLog(MappedLog const&) = delete;
+  MappedLog& operator=(MappedLog const&) = delete;
+
+  // returns offset of appended data
+  uint64_t append(uint8_t const* bytes, size_t len);
+  uint8_t const* at(uint64_t off) const { return data + off; }
+  size_t size() const { return used; }
+};
+
+// encoded state to be looked up, given by position in some buffer and fingerprint
+struct StoreQuery {
+  size_t off;
+  size_t len;
+  uint64_t fp;
+};
+
+// state table of a determinization: DetStates are stored in a compact encoding
+// (bitsets only with the words needed for the NBA), numbered in insertion order.
+class DetStateStore {
+  unsigned words;  // 64 bit words per bitset
+  MappedLog log;
+  vector<uint64_t> offsets; // start of each state in log
+  vector<uint64_t> fps;     // fingerprint of each state
+  vector<state_t> slots;    // open addressing index: fingerprint -> state
+
+  size_t length(state_t s) const;
+  bool same(state_t s, uint8_t const* bytes, size_t len, uint64_t fp) const;
+  void index(state_t s);
+  state_t add(uint8_t const* bytes, size_t len, uint64_t fp);
+
+public:
+  // nbastates is the largest NBA state + 1
+  DetStateStore(string const& dir, size_t nbastates);
+
+  size_t size() const { return offsets.size(); }
+  size_t disk_bytes() const { return log.size(); }
+  size_t index_bytes() const;
+
+  // encoding of a state (buf is overwritten)
+  void encode(DetState const& ds, vector<uint8_t>& buf) const;
+  static uint64_t fingerprint(uint8_t const* bytes, size_t len);
+
+  DetState get(state_t s) const;
+
+  // returns id of state with given encoding and whether it was added
+  pair<state_t, bool> put_or_get(uint8_t const* bytes, size_t len, uint64_t fp);
+
+  // returns ids of the states with the given (pairwise different) encodings in bytes.
+  // candidates are found by fingerprint in the index and then compared in the order
+  // of their position in the log, so it is read in one ascending pass instead of
+  // at random offsets. missing states are added in the given order.
+  vector<state_t> put_or_get_all(uint8_t const* bytes, vector<StoreQuery> const& qs);
+};
+
+}  // namespace nbautils
@@ -10,6 +10,7 @@
 
 // C++ Standard Library
 #include <cstdint>
+#include <fstream>
 #include <iostream>
 #include <string>
 
@@ -19,11 +20,14 @@
 // nbautils
 #include "aut.hh"
 #include "io.hh"
+#include "metrics/profiler.hh"
 
 // Compl
 #include "compl/compl_constr1.hh"
 #include "compl/compl_constr2.hh"
 #include "compl/compl_constr3.hh"
+#include "compl/compl_incl.hh"
+#include "compl/compl_otf.hh"
 #include "compl/compl_print.hh"
 #include "compl/compl_tag.hh"
 #include "compl/compl_tests.hh"		// Test methods
@@ -44,10 +48,17 @@ struct Args{
 	bool out;			/// True, if the output should be additionally stored in a file
 	string output_path;	/// The path of the output-file
 	bool stats;			/// True, if statistics should be output
+	string profile;		/// If not empty, the aggregated time per phase is written to this file as JSON
+	string profile_trace;	/// If not empty, all phases are written to this file in Chrome trace format
 
 	bool constr1;		/// Construction using STS and rankings
 	bool constr2;		/// Construction using PS and rankings
 	bool constr3;		/// Construction using PS and rankings with optimizations
+
+	bool phased;		/// True, if the stages of the constructions should be built one after another instead of on-the-fly
+	unsigned jobs;		/// Number of threads for the on-the-fly constructions
+
+	string incl_path;	/// If not empty, the language inclusion of the input-automata in the first automaton of this file is checked
 };
 
 
@@ -92,6 +103,26 @@ Args parse_args(int argc, char* argv[]){
 		"Choose this option if only the statistics of the resulting automata for the selected constructions are relevant. The automata will not be output.",
 		{'s', "stats"});
 
+	args::ValueFlag<string> profile(parser, "profile_file",
+		"Measures the time spent in the phases of the calculation (parsing, constructions, output) and writes the aggregated times as JSON to the given file.",
+		{"profile"});
+
+	args::ValueFlag<string> profile_trace(parser, "trace_file",
+		"Writes every phase of the calculation to the given file in the trace-event format of Chrome (chrome://tracing).",
+		{"profile-trace"});
+
+	args::Flag phased(parser, "phased",
+		"Builds the stages of the chosen constructions one after another, as described in the thesis, instead of exploring the complementary automaton on-the-fly. The resulting automata are the same up to the numbering of the states.",
+		{"phased"});
+
+	args::ValueFlag<unsigned> jobs(parser, "jobs",
+		"Number of threads that compute successor-states in the on-the-fly constructions (default: 1).",
+		{'j', "jobs"}, 1);
+
+	args::ValueFlag<string> incl_path(parser, "incl_file",
+		"Instead of complementing, checks for each input-automaton whether its language is included in the language of the first automaton in the given file. The complementary automaton of that automaton is only constructed as far as needed (via constr3, unless another construction is chosen). For each input-automaton, 'included' or 'not included' with a counterexample is output.",
+		{"incl"});
+
 	// Complementation constructions
 	args::Group constr(parser,
 		"The following options are construction-approaches for complementary Büchi-automata.  In case that several construction methods are chosen, the output will be ordered according to: constr1, constr2, constr3.");
@@ -147,11 +178,17 @@ Args parse_args(int argc, char* argv[]){
 	res.all = all;
 	res.no_cout = no_cout;
 	res.stats = stats;
+	res.profile = args::get(profile);
+	res.profile_trace = args::get(profile_trace);
 
 	res.constr1 = constr1;
 	res.constr2 = constr2;
 	res.constr3 = constr3;
 
+	res.phased = phased;
+	res.jobs = args::get(jobs);
+	res.incl_path = args::get(incl_path);
+
 
 	return res;
 }
@@ -181,6 +218,123 @@ uint64_t num_trans(auto const& aut){
 }
 
 
+/**
+*	\brief	Writes the measured phases to the files given by --profile and --profile-trace.
+*
+*	\param args	The parsed commandline-arguments.
+*/
+void write_profile(Args const& args){
+	if(!args.profile.empty()){
+		ofstream profile_out(args.profile);
+		Profiler::get().write_json(profile_out);
+	}
+	if(!args.profile_trace.empty()){
+		ofstream trace_out(args.profile_trace);
+		Profiler::get().write_trace(trace_out);
+	}
+}
+
+
+/**
+*	\brief	Returns the letters of a word, separated by semicolons.
+*
+*	\param word	The letters.
+*	\param aps	The atomic propositions of the alphabet.
+*/
+string word_to_str(vector<sym_t> const& word, vector<string> const& aps){
+	string res;
+	for(auto const x : word){
+		if(!res.empty()){ res += "; "; }
+		res += sym_to_edgelabel(x, aps, true);
+	}
+	return res;
+}
+
+
+/**
+*	\brief	Checks the language inclusion of the input-automata in the automaton given by args.incl_path.
+*
+*	For each input-automaton, a line "included" or "not included: " followed by a counterexample
+*	(in the form "stem; cycle{loop}") is output. With statistics, the number of explored product states
+*	and constructed states of the complementary automaton are appended.
+*
+*	\param args	The parsed commandline-arguments.
+*
+*	\return	The exit code of the program.
+*/
+int check_inclusion(Args const& args){
+	nbautils::AutStream<nbautils::Aut<string>> inclstream(args.incl_path);
+	if(!inclstream.has_next()){
+		cerr << "File  \"" << args.incl_path << "\"  does not contain an automaton." << endl;
+		return 1;
+	}
+	auto incl = inclstream.parse_next();
+	if(!incl.is_buchi()){
+		cerr << "The automaton in \"" << args.incl_path << "\" is not a state-based Büchi automaton." << endl;
+		return 1;
+	}
+	incl.make_colored();
+	if(incl.states().size() > max_nba_states){
+		cerr << "The automaton in \"" << args.incl_path << "\" has too many states. Please make sure that the automaton has at most " << max_nba_states << " states." << endl;
+		return 1;
+	}
+	if(incl.syms().size() > max_nba_syms){
+		cerr << "The automaton in \"" << args.incl_path << "\" has too many letters. Please make sure that the alphabet has at most " << max_nba_syms << " letters." << endl;
+		return 1;
+	}
+
+	ComplConstr const constr = args.constr1 ? ComplConstr::al : args.constr2 ? ComplConstr::ps : ComplConstr::ps_opt;
+
+	nbautils::AutStream<nbautils::Aut<string>> autstream(args.input_path);
+	if(!autstream.has_next()){
+		cerr << "File  \"" << args.input_path << "\"  does not contain an automaton." << endl;
+		return 1;
+	}
+
+	ofstream output;
+	if(args.out){
+		output.open(args.output_path);
+	}
+
+	do {
+		Aut<string> aut;
+		{
+			PROF_PHASE("parse");
+			aut = autstream.parse_next();
+		}
+		if(!aut.is_buchi()){
+			cerr << "The input-automaton is not a state-based Büchi automaton." << endl;
+			return 1;
+		}
+		if(aut.get_aps() != incl.get_aps()){
+			cerr << "The automata have different atomic propositions." << endl;
+			return 1;
+		}
+
+		InclResult res;
+		{
+			PROF_PHASE("inclusion");
+			res = nba_inclusion(aut, incl, constr);
+		}
+
+		string line = res.included ? "included" : "not included: ";
+		if(!res.included){
+			if(!res.stem.empty()){ line += word_to_str(res.stem, aut.get_aps()) + "; "; }
+			line += "cycle{" + word_to_str(res.loop, aut.get_aps()) + "}";
+		}
+		if(args.stats){
+			line += ", " + to_string(res.prodStates) + ", " + to_string(res.complStates);
+		}
+
+		if(!args.no_cout){ cout << line << endl; }
+		if(args.out){ output << line << endl; }
+
+	} while (args.all && autstream.has_next());
+
+	return 0;
+}
+
+
 /**
 *	\brief main-function of the compl-module.
 *
@@ -194,6 +348,18 @@ int main(int argc, char* argv[]){
 	// Parse arguments
 	auto const args = parse_args(argc, argv);
 
+	// Enable profiler if requested
+	if(!args.profile.empty() || !args.profile_trace.empty()){
+		Profiler::get().enable(!args.profile_trace.empty());
+	}
+
+	// Language inclusion instead of complementation
+	if(!args.incl_path.empty()){
+		int const ret = check_inclusion(args);
+		write_profile(args);
+		return ret;
+	}
+
 	// If no construction-method is chosen, return 0
 	if(!args.constr1 && !args.constr2 && !args.constr3){
 		cerr << "No construction method chosen." << endl;
@@ -250,7 +416,10 @@ int main(int argc, char* argv[]){
 
 	// Execution according to arguments
 	do {
-		aut = autstream.parse_next();
+		{
+			PROF_PHASE("parse");
+			aut = autstream.parse_next();
+		}
         aut.make_colored();
 
 		// Check whether the input-automaton has too many states
@@ -267,7 +436,13 @@ int main(int argc, char* argv[]){
 
 
 		if(args.constr1){
-			auto const AL = al_construction(aut, get_adjmat(aut));
+			ComplAut AL;
+			{
+				PROF_PHASE("constr1");
+				AL = args.phased ? al_construction(aut, get_adjmat(aut))
+				                 : compl_construction_otf(aut, get_adjmat(aut), ComplConstr::al, args.jobs);
+			}
+			PROF_PHASE("output");
 
 			// Statistics-output
 			if(args.stats){
@@ -290,7 +465,13 @@ int main(int argc, char* argv[]){
 		}
 
 		if(args.constr2){
-			auto const Acomp = compl_construction(aut, get_adjmat(aut));
+			ComplAut Acomp;
+			{
+				PROF_PHASE("constr2");
+				Acomp = args.phased ? compl_construction(aut, get_adjmat(aut))
+				                    : compl_construction_otf(aut, get_adjmat(aut), ComplConstr::ps, args.jobs);
+			}
+			PROF_PHASE("output");
 
 			// Statistics-output
 			if(args.stats){
@@ -313,7 +494,13 @@ int main(int argc, char* argv[]){
 		}
 
 		if(args.constr3){
-			auto const Aopt = compl_construction_opt(aut, get_adjmat(aut));
+			ComplAut Aopt;
+			{
+				PROF_PHASE("constr3");
+				Aopt = args.phased ? compl_construction_opt(aut, get_adjmat(aut))
+				                   : compl_construction_otf(aut, get_adjmat(aut), ComplConstr::ps_opt, args.jobs);
+			}
+			PROF_PHASE("output");
 
 			// Statistics-output
 			if(args.stats){
@@ -338,5 +525,7 @@ int main(int argc, char* argv[]){
 
 	output.close();		// Close stream of output-file
 
+	write_profile(args);
+
 	return 0;
 }
@@ -0,0 +1,379 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <iomanip>
+using namespace std;
+
+#include <unistd.h>
+#include <fcntl.h>
+
+#include <spdlog/spdlog.h>
+namespace spd = spdlog;
+#include <args.hxx>
+
+#include "metrics/memusage.h"
+
+#include "aut.hh"
+#include "hoa_reader.hh"
+#include "common/jobs.hh"
+#include "tools/nbadet.hh"
+
+using namespace nbautils;
+
+//nbadet-bench - runs a matrix of nbadet configurations on a corpus of NBAs.
+//each run happens in a forked worker (so time and memory of runs do not mix
+//and runaway configurations can be killed), the determinization itself is
+//the same code as in nbadet. results can be written as CSV/JSON and compared
+//against an earlier CSV result to detect regressions.
+
+struct BenchArgs {
+  vector<string> files;
+  vector<string> matrix;
+  int verbose;
+
+  int jobs;
+  int repeat;
+  double timeout;
+  int memory;
+
+  string csv;
+  string json;
+
+  string baseline;
+  double time_threshold;
+  double mem_threshold;
+  double noise;
+  double mem_noise;
+};
+
+BenchArgs parse_bench_args(int argc, char *argv[]) {
+  args::ArgumentParser parser("nbadet-bench - run nbadet configurations on a corpus of NBAs",
+      "Each -m gives comma-separated alternatives for one dimension of the option matrix, "
+      "an empty alternative means no option. E.g. -m '-k -j' -m '-u0,-u1,-u2' -m ',-t' "
+      "runs 6 configurations.");
+  args::HelpFlag help(parser, "help", "Display this help menu", {'h', "help"});
+
+  args::PositionalList<string> files(parser, "FILES", "HOA files with NBAs");
+
+  args::CounterFlag verbose(parser, "verbose", "Show verbose information",
+      {'v', "verbose"});
+  args::ValueFlagList<string> matrix(parser, "OPTS", "Alternatives of one matrix dimension (default: -u0,-u1,-u2)",
+      {'m', "matrix"});
+
+  args::ValueFlag<int> jobs(parser, "N", "Number of parallel runs (default: 1, more distorts timing)",
+      {"jobs"}, 1);
+  args::ValueFlag<int> repeat(parser, "N", "Repeat each run N times, keep the fastest (default: 1)",
+      {"repeat"}, 1);
+  args::ValueFlag<double> timeout(parser, "SECS", "Give up on a run after SECS seconds",
+      {"timeout"});
+  args::ValueFlag<int> memory(parser, "MB", "Give up on a run using more than MB megabytes",
+      {"memory"});
+
+  args::ValueFlag<string> csv(parser, "FILE", "Write results as CSV to FILE (default: stdout)",
+      {"csv"});
+  args::ValueFlag<string> json(parser, "FILE", "Write results as JSON to FILE",
+      {"json"});
+
+  args::ValueFlag<string> baseline(parser, "FILE", "Compare with results in CSV FILE, exit with 1 on regressions",
+      {"baseline"});
+  args::ValueFlag<double> time_threshold(parser, "X", "Time regression if slower by factor X (default: 1.2)",
+      {"time-threshold"}, 1.2);
+  args::ValueFlag<double> mem_threshold(parser, "X", "Memory regression if larger by factor X (default: 1.2)",
+      {"mem-threshold"}, 1.2);
+  args::ValueFlag<double> noise(parser, "SECS", "Ignore time differences below SECS (default: 0.05)",
+      {"noise"}, 0.05);
+  args::ValueFlag<double> mem_noise(parser, "MB", "Ignore memory differences below MB (default: 1)",
+      {"mem-noise"}, 1.0);
+
+  try {
+    parser.ParseCLI(argc, argv);
+  } catch (args::Help&) {
+    std::cout << parser;
+    exit(0);
+  } catch (args::ParseError& e) {
+    std::cerr << e.what() << std::endl;
+    std::cerr << parser;
+    exit(1);
+  } catch (args::ValidationError& e) {
+    std::cerr << e.what() << std::endl;
+    std::cerr << parser;
+    exit(1);
+  }
+
+  BenchArgs args;
+  args.files = args::get(files);
+  args.matrix = args::get(matrix);
+  args.verbose = args::get(verbose);
+  args.jobs = args::get(jobs);
+  args.repeat = args::get(repeat);
+  args.timeout = args::get(timeout);
+  args.memory = args::get(memory);
+  args.csv = args::get(csv);
+  args.json = args::get(json);
+  args.baseline = args::get(baseline);
+  args.time_threshold = args::get(time_threshold);
+  args.mem_threshold = args::get(mem_threshold);
+  args.noise = args::get(noise);
+  args.mem_noise = args::get(mem_noise);
+
+  if (args.files.empty()) {
+    std::cerr << "No input files given!" << std::endl;
+    exit(1);
+  }
+  if (args.jobs < 1 || args.repeat < 1) {
+    std::cerr << "--jobs and --repeat must be positive!" << std::endl;
+    exit(1);
+  }
+  return args;
+}
+
+vector<string> split(string const& s, char sep) {
+  vector<string> ret;
+  stringstream ss(s);
+  string it;
+  while (getline(ss, it, sep))
+    ret.push_back(it);
+  if (!s.empty() && s.back() == sep)
+    ret.push_back("");
+  return ret;
+}
+
+//cartesian product of the dimensions, each configuration is an nbadet option line
+vector<string> expand_matrix(vector<string> const& dims) {
+  vector<string> ret{""};
+  for (auto const& dim : dims) {
+    vector<string> next;
+    for (auto const& pre : ret)
+      for (auto const& alt : split(dim, ',')) {
+        if (alt.find_first_not_of(' ') == string::npos)
+          next.push_back(pre);
+        else
+          next.push_back(pre.empty() ? alt : pre + " " + alt);
+      }
+    ret = next;
+  }
+  return ret;
+}
+
+struct RunResult {
+  string input;
+  string config;
+  string status;
+  double secs = 0;
+  double mem_mb = 0; //growth of peak RSS during the run
+  size_t states = 0;
+  size_t pris = 0;
+};
+
+//runs in worker: determinize and report measurements as one line
+string measure_run(string const& config, Aut<string> aut, std::shared_ptr<spdlog::logger> log) {
+  //nbadet may print stats, but stdout belongs to the results
+  int const devnull = open("/dev/null", O_WRONLY);
+  if (devnull >= 0)
+    dup2(devnull, STDOUT_FILENO);
+
+  auto const args = parse_args_line(config);
+  check_input(aut, log);
+
+  size_t const rss = getCurrentRSS();
+  auto const start = get_time();
+  PA const pa = process_nba_with_fallback(args, aut, log);
+  double const secs = get_secs_since(start);
+  size_t const peak = getPeakRSS();
+
+  stringstream ss;
+  ss << secs << " " << (peak > rss ? peak - rss : 0) << " " << pa.num_states() << " " << pa.pris().size();
+  return ss.str();
+}
+
+RunResult to_run_result(JobResult const& res) {
+  RunResult ret;
+  ret.status = to_string(res.status);
+  ret.secs = res.secs;
+  if (res.status == JobStatus::ok) {
+    size_t mem;
+    stringstream ss(res.output);
+    ss >> ret.secs >> mem >> ret.states >> ret.pris;
+    ret.mem_mb = mem / (1024.0 * 1024.0);
+  }
+  return ret;
+}
+
+void write_csv(ostream& out, vector<RunResult> const& rs) {
+  out << "input,config,status,secs,mem_mb,states,pris" << endl;
+  out << fixed << setprecision(4);
+  for (auto const& r : rs)
+    out << r.input << "," << r.config << "," << r.status << "," << r.secs << ","
+        << r.mem_mb << "," << r.states << "," << r.pris << endl;
+}
+
+void write_json(ostream& out, vector<RunResult> const& rs) {
+  out << "[" << endl << fixed << setprecision(4);
+  for (size_t i = 0; i < rs.size(); i++) {
+    auto const& r = rs[i];
+    out << "{\"input\": \"" << r.input << "\", \"config\": \"" << r.config
+        << "\", \"status\": \"" << r.status << "\", \"secs\": " << r.secs
+        << ", \"mem_mb\": " << r.mem_mb << ", \"states\": " << r.states
+        << ", \"pris\": " << r.pris << "}" << (i+1 < rs.size() ? "," : "") << endl;
+  }
+  out << "]" << endl;
+}
+
+vector<RunResult> read_csv(string const& filename) {
+  ifstream in(filename);
+  if (!in)
+    throw runtime_error("cannot read baseline " + filename + "!");
+  vector<RunResult> ret;
+  string line;
+  getline(in, line); //header
+  while (getline(in, line)) {
+    auto const cols = split(line, ',');
+    if (cols.size() != 7)
+      throw runtime_error("malformed line in baseline: " + line);
+    RunResult r;
+    r.input = cols[0];
+    r.config = cols[1];
+    r.status = cols[2];
+    r.secs = stod(cols[3]);
+    r.mem_mb = stod(cols[4]);
+    r.states = stoul(cols[5]);
+    r.pris = stoul(cols[6]);
+    ret.push_back(r);
+  }
+  return ret;
+}
+
+//report differences to baseline, returns number of regressions
+int compare_baseline(BenchArgs const& args, vector<RunResult> const& rs, vector<RunResult> const& base) {
+  map<pair<string, string>, RunResult> old;
+  for (auto const& r : base)
+    old[make_pair(r.input, r.config)] = r;
+
+  int regressions = 0;
+  auto const report = [&](RunResult const& r, string const& what) {
+    cerr << "REGRESSION " << r.input << " [" << r.config << "]: " << what << endl;
+    regressions++;
+  };
+
+  int compared = 0;
+  for (auto const& r : rs) {
+    auto const it = old.find(make_pair(r.input, r.config));
+    if (it == old.end())
+      continue;
+    auto const& b = it->second;
+    compared++;
+
+    stringstream ss;
+    ss << fixed << setprecision(3);
+    if (b.status == "ok" && r.status != "ok") {
+      report(r, r.status + " (was ok)");
+      continue;
+    }
+    if (b.status != "ok" || r.status != "ok")
+      continue;
+
+    if (r.states > b.states) {
+      ss << "states " << b.states << " -> " << r.states;
+      report(r, ss.str());
+    } else if (r.secs > b.secs * args.time_threshold && r.secs - b.secs > args.noise) {
+      ss << "time " << b.secs << " s -> " << r.secs << " s";
+      report(r, ss.str());
+    } else if (r.mem_mb > b.mem_mb * args.mem_threshold && r.mem_mb - b.mem_mb > args.mem_noise) {
+      ss << "memory " << b.mem_mb << " MB -> " << r.mem_mb << " MB";
+      report(r, ss.str());
+    }
+  }
+
+  cerr << "compared " << compared << " runs with baseline, "
+       << regressions << " regressions" << endl;
+  return regressions;
+}
+
+int main(int argc, char *argv[]) {
+  auto const log = spd::stderr_logger_mt("log");
+  spd::set_pattern("[%Y-%m-%d %H:%M:%S %z] [%l] %v");
+
+  auto const args = parse_bench_args(argc, argv);
+  if (!args.verbose)
+    spd::set_level(spd::level::warn);
+  else
+    spd::set_level(spd::level::info);
+
+  auto const configs = expand_matrix(args.matrix.empty() ? vector<string>{"-u0,-u1,-u2"} : args.matrix);
+  for (auto const& config : configs)
+    parse_args_line(config); //validate early (exits on error)
+
+  //load corpus
+  vector<pair<string, Aut<string>>> corpus;
+  for (auto const& file : args.files) {
+    string const base = file.substr(file.find_last_of('/') + 1);
+    auto auts = HOAStream(file, log);
+    int i = 0;
+    while (auts.has_next()) {
+      corpus.emplace_back(i ? base + "#" + to_string(i) : base, auts.parse_next());
+      i++;
+    }
+  }
+  log->info("{} automata x {} configurations", corpus.size(), configs.size());
+
+  JobLimits lim;
+  lim.timeout = args.timeout;
+  lim.memory = static_cast<size_t>(args.memory) * 1024 * 1024;
+  JobPool pool(args.jobs, lim);
+
+  vector<RunResult> results;
+  map<size_t, size_t> job_to_run; //job id -> index of result
+  auto const collect = [&](JobResult const& res) {
+    auto r = to_run_result(res);
+    auto& cur = results.at(job_to_run.at(res.id));
+    //keep fastest successful repetition
+    if (cur.status.empty() || (r.status == "ok" && (cur.status != "ok" || r.secs < cur.secs))) {
+      r.input = cur.input;
+      r.config = cur.config;
+      cur = r;
+    }
+    log->info("{} [{}]: {} ({:.3f} s)", cur.input, cur.config, to_string(res.status), r.secs);
+  };
+
+  for (auto const& it : corpus) {
+    for (auto const& config : configs) {
+      RunResult r;
+      r.input = it.first;
+      r.config = config;
+      results.push_back(r);
+
+      for (int i = 0; i < args.repeat; i++) {
+        auto const id = pool.submit([&]() { return measure_run(config, it.second, log); });
+        job_to_run[id] = results.size() - 1;
+        while (pool.has_result())
+          collect(pool.next_result());
+      }
+    }
+  }
+  while (pool.pending())
+    collect(pool.next_result());
+
+  if (!args.csv.empty()) {
+    ofstream out(args.csv);
+    write_csv(out, results);
+  }
+  if (!args.json.empty()) {
+    ofstream out(args.json);
+    write_json(out, results);
+  }
+  if (args.csv.empty() && args.json.empty())
+    write_csv(cout, results);
+
+  if (!args.baseline.empty()) {
+    try {
+      if (compare_baseline(args, results, read_csv(args.baseline)) > 0)
+        return 1;
+    } catch (std::exception& e) {
+      log->error(e.what());
+      return 1;
+    }
+  }
+}
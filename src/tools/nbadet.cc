@@ -1,450 +1,316 @@
 #include <iostream>
+#include <sstream>
 #include <string>
+#include <cstring>
+#include <cerrno>
 #include <cassert>
 using namespace std;
 
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
 #include <spdlog/spdlog.h>
 namespace spd = spdlog;
 #include <args.hxx>
 
 #include "metrics/bench.hh"
+#include "metrics/profiler.hh"
+#include "metrics/counters.hh"
+#include "metrics/memstats.hh"
 #include "metrics/memusage.h"
 
 #include "aut.hh"
 #include "io.hh"
+#include "hoa_reader.hh"
+#include "cache.hh"
 #include "graph.hh"
 #include "common/scc.hh"
+#include "common/jobs.hh"
 #include "ps.hh"
 #include "pa.hh"
 #include "preproc.hh"
 #include "detstate.hh"
 #include "det.hh"
+#include "tools/nbadet.hh"
 
 using namespace nbautils;
 
-struct Args {
-  string file;
-
-  int verbose;
-  bool stats;
-  bool nooutput;
-
-  bool trim;
-  bool asinks;
-  bool dsim;
-  bool prunesim;
-  bool mindfa;
-
-  int mergemode;
-  bool puretrees;
-
-  bool psets;
-  bool context;
-  bool approx;
-
-  bool seprej;
-  bool sepacc;
-  bool cyclicbrk;
-  bool sepmix;
-  bool optdet;
-  bool optsuc;
-  bool hitset;
-
-  bool z; //for experimental behaviour, no fixed meaning
-};
-
-Args parse_args(int argc, char *argv[]) {
-  args::ArgumentParser parser("nbadet - determinize nondeterministic Büchi automata", "");
-  args::HelpFlag help(parser, "help", "Display this help menu", {'h', "help"});
-
-  args::Positional<string> input(parser, "INPUTFILE",
-      "file containing the NBA(s) (if none given, uses <stdin>)");
-
-  // introspection and debugging
-  args::CounterFlag verbose(parser, "verbose", "Show verbose information",
-      {'v', "verbose"}); // logging level -v, -vv, etc.
-  args::CounterFlag stats(parser, "stats", "Output stats about structure",
-      {'s', "output-stats"});
-  args::Flag nooutput(parser, "nooutput", "Do not print resulting automaton",
-      {'x', "no-output"});
-
-  // preprocessing on NBA (known, simple stuff)
-  args::Flag trim(parser, "trim", "Kill dead states from NBA.",
-      {'k', "trim"});
-  args::Flag asinks(parser, "asinks", "Detect and use accepting (pseudo)sinks.",
-      {'j', "acc-sinks"});
-  args::Flag dsim(parser, "dsim", "Use direct simulation for preprocessing and optimization.",
-      {'i', "dir-sim"});
-  args::Flag prunesim(parser, "prunesim", "Use direct simulation to prune trees heuristically.",
-      {'r', "prune-sim"});
-  args::Flag approx(parser, "underapprox", "Iteratively underapproximate the Safra trees.",
-      {'p', "approx"});
-  args::Flag optsuc(parser, "optsuc", "Optimize successor selection using existing states if possible.",
-      {'o', "opt-succ"});
-  args::Flag hitset(parser, "hitset-opt", "Optimize using hitset calculation.",
-      {'q', "hitset"});
-
-  // postprocessing
-  args::Flag mindfa(parser, "mindfa", "First minimize number of priorities, "
-      "then minimize number of states using Hopcroft",
-      {'m', "minimize-dfa"});
-
-  // type of update for active ranks
-  args::ValueFlag<int> mergemode(parser, "N", "Type of update "
-      "(0=Muller/Schupp, 1=Safra, 2=Maximal merge)",
-      {'u', "update-mode"});
-  args::Flag puretrees(parser, "pure", "Accepting leaf normal form (acc. states in leaves only)",
-      {'l', "pure-trees"});
-
-  // used to weed out redundant SCCs in det. automaton
-  args::Flag psets(parser, "powersets", "Use powerset SCCs to guide determinization",
-      {'t', "use-powersets"});
-
-  // additional calculations on NBA to optimize construction
-  args::Flag context(parser, "context", "Calculate context for separation refinement",
-      {'c', "use-context"});
-
-  // enabled optimizations for Safra/Level update
-  args::Flag seprej(parser, "seprej", "Separate states in non-accepting SCCs",
-      {'n', "sep-rej"});
-  args::Flag sepacc(parser, "sepacc", "Separate states in accepting SCCs",
-      {'a', "sep-acc"});
-  args::Flag cyclicbrk(parser, "cyclicbrk", "Separate states in accepting SCCs, cycle through SCCs",
-      {'b', "cyclic-breakpoint"});
-  args::Flag sepmix(parser, "sepmix", "Separate states in different SCCs",
-      {'e', "sep-mix"});
-  args::Flag optdet(parser, "optdet", "Optimize deterministic SCCs by not expanding trees",
-      {'d', "opt-det"});
-
-  // ----
-  // args::Flag z(parser, "z", "Surprise!", {'z', "z"}); //NOTE: this should be commented out in commits
-  bool z = false; //dummy flag, always false
-  // ----
-
-  // NOTES:
-  // strictly good and cheap optimizations are: -k, -t, -j, -i, -r
-  // mostly good, seldom bad and cheap: -n -a -b -d -e -l
-  // usually very good and sometimes slightly more expensive: -o -q
-  // very good and very expensive: -m
-  // usually the best update mode is: -u1
-  //
-  // some "bad" LTL formulas witnessed negative interactions of:
-  // (-e or -d) and -i (slight state increase)
-  // -l and -r (significant increase)
-  // but overall all contribute positive on average
-  //
-  // it may be that together -o and -t are not as effective as on their own
-  // TODO:
-  // this MAYBE can be remedied by changing the way -t works s.t. exploration
-  // is started from a "real" successor instead of just the powerset
-  //
-  // The underapproximation (-p) and context (-c) empirically have
-  // never shown positive and sometimes even negative effect
-  // and therefore should not be used.
-
-  try {
-    parser.ParseCLI(argc, argv);
-  } catch (args::Help&) {
-    std::cout << parser;
-    exit(0);
-  } catch (args::ParseError& e) {
-    cerr << e.what() << endl << parser;
-    exit(1);
-  } catch (args::ValidationError& e) {
-    cerr << e.what() << endl << parser;
-    exit(1);
-  }
+//process automata in forked workers, but print results in input order.
+//automata that fail, time out or run out of memory are reported and skipped.
+JobLimits limits_from_args(Args const& args) {
+  JobLimits lim;
+  lim.timeout = args.timeout;
+  lim.memory = static_cast<size_t>(args.memory) * 1024 * 1024;
+  return lim;
+}
 
-  if (context && !(seprej || sepacc)) {
-    spd::get("log")->error("-c without at least one of -a or -n is useless!");
-    exit(1);
-  }
+string pa_to_hoa(PA const& pa) {
+  PROF_PHASE("print");
+  stringstream ss;
+  print_aut(pa, ss);
+  return ss.str();
+}
 
-  if (context && optsuc) {
-    spd::get("log")->error("-c does not work with -o!");
-    exit(1);
+//NBA -> DPA in HOA format
+string determinize_to_hoa(Args const &args, auto& aut, std::shared_ptr<spdlog::logger> log) {
+  if (!args.out_of_core.empty()) { //the DPA does not fit into memory, it is printed directly
+    auto const dc = preprocess_nba(args, aut, log);
+    ostream nullout(nullptr);
+    ostream& out = args.nooutput ? nullout : cout;
+    auto const st = bench(log, "determinize_out_of_core",
+                          WRAP(determinize_out_of_core(aut, dc, args.out_of_core, out)));
+    log->info("{} states, {} edges, {} MB state log, {} MB index",
+              st.states, st.edges, st.disk_bytes >> 20, st.index_bytes >> 20);
+    return "";
   }
 
-  if (cyclicbrk && !sepacc) {
-    spd::get("log")->error("-b without -a is useless!");
-    exit(1);
+  if (args.nooutput) {
+    bench(log,"process_nba", WRAP(process_nba_with_fallback(args, aut, log)));
+    return "";
   }
 
-  if (mergemode && args::get(mergemode) >= static_cast<int>(UpdateMode::num)) {
-    spd::get("log")->error("Invalid update mode provided: {}", args::get(mergemode));
-    exit(1);
+  if (args.cache.empty()) {
+    PA const pa = bench(log,"process_nba", WRAP(process_nba_with_fallback(args, aut, log)));
+    return pa_to_hoa(pa);
   }
 
-  //fill args
-  Args args;
-  if (input) {
-    string filename = args::get(input);
-    ifstream exists(filename);
-    if (!exists) {
-      spd::get("log")->error("File does not exist: {}", filename);
-    }
-    args.file = filename;
+  //the canonical form is only the key, the input itself is determinized, as the state
+  //names of the DPA refer to its states. entries start with (a hash of) the numbering
+  //they were computed for, for other numberings the names are dropped.
+  PROF_PHASE("cache");
+  string const key = options_key(args) + "\n" + structure_key(canonical_form(aut));
+  string const numbering = to_string(fnv1a_hash(structure_key(aut)));
+  ResultCache const cache(args.cache);
+  string ret;
+  if (cache.lookup(key, ret)) {
+    log->info("cache hit for \"{}\"", aut.get_name());
+    size_t const nl = ret.find('\n');
+    string const hoa = with_hoa_name(ret.substr(nl+1), aut.get_name());
+    return ret.compare(0, nl, numbering) == 0 ? hoa : without_hoa_state_names(hoa);
   }
 
-  args.verbose = args::get(verbose);
-  args.stats = stats;
-  args.nooutput = nooutput;
-
-  args.trim = trim;
-  args.asinks = asinks;
-  args.dsim = dsim;
-  args.prunesim = prunesim;
-  args.mindfa = mindfa;
-
-  args.psets = psets;
-  args.context = context;
-  args.approx = approx;
-
-  args.mergemode = args::get(mergemode);
-  args.puretrees = puretrees;
-
-  args.seprej = seprej;
-  args.sepacc = sepacc;
-  args.cyclicbrk = cyclicbrk;
-  args.sepmix = sepmix;
-  args.optdet = optdet;
-
-  args.optsuc = optsuc;
-  args.hitset = hitset;
-
-  args.z = z;
-
-  return args;
+  size_t fallbacks = 0;
+  PA const pa = bench(log,"process_nba", WRAP(process_nba_with_fallback(args, aut, log, &fallbacks)));
+  ret = pa_to_hoa(pa);
+  if (!fallbacks) //results of fallback options do not belong to this key
+    cache.store(key, numbering + "\n" + ret);
+  return ret;
 }
 
-//fill DetConf flags from args
-DetConf detconf_from_args(Args const& args) {
-  DetConf dc;
-
-  dc.debug = args.verbose > 2;
-
-  dc.update = static_cast<UpdateMode>(args.mergemode);
-  dc.puretrees = args.puretrees;
-
-  dc.sep_rej = args.seprej;
-  dc.sep_acc = args.sepacc;
-  dc.sep_acc_cyc = args.cyclicbrk;
-  dc.sep_mix = args.sepmix;
-  dc.opt_det = args.optdet;
+//returns exit code: 3 if some automaton exceeded a limit, 1 if some other failed, else 0
+int process_batch(Args const &args, HOAStream& auts, std::shared_ptr<spdlog::logger> log) {
+  if (Profiler::get().is_enabled())
+    log->warn("the profile only covers the main process, not the workers!");
+  JobPool pool(args.jobs, limits_from_args(args));
+
+  vector<string> names;
+  bool failed = false;
+  bool aborted = false;
+  auto const emit = [&](JobResult const& res) {
+    if (res.status == JobStatus::ok) {
+      cout << res.output << flush;
+      log->info("automaton #{} done ({:.3f} s)", res.id, res.secs);
+    } else {
+      log->error("automaton #{} (\"{}\"): {} after {:.3f} s {}",
+                 res.id, names.at(res.id), to_string(res.status), res.secs, res.output);
+      if (res.status == JobStatus::failed)
+        failed = true;
+      else
+        aborted = true;
+    }
+  };
 
-  dc.opt_suc = args.optsuc;
-  dc.hitset = args.hitset;
+  while (auts.has_next()) {
+    auto aut = auts.parse_next();
+    names.push_back(aut.get_name());
+
+    //rejected in the worker, so that the batch goes on with the next automaton
+    pool.submit([&]() {
+      log->info("NBA name: \"{}\", #states: {}, #APs: {} #Syms: {}",
+                aut.get_name(), aut.num_states(), aut.get_aps().size(), aut.num_syms());
+      string const problem = input_problem(aut);
+      if (!problem.empty())
+        throw runtime_error(problem);
+      try {
+        return determinize_to_hoa(args, aut, log);
+      } catch (BudgetExceeded const& e) {
+        throw JobAborted(e.what());
+      }
+    });
 
-  dc.z = args.z;
+    while (pool.has_result())
+      emit(pool.next_result());
+  }
 
-  return dc;
+  while (pool.pending())
+    emit(pool.next_result());
+  return aborted ? 3 : failed ? 1 : 0;
 }
 
-//given NBA and detconf without sets, return the corresponding configured sets
-DetConfSets get_detconfsets(auto const& aut, DetConf const& dc,
-                    shared_ptr<spdlog::logger> log = nullptr) {
-  auto const aut_suc = aut_succ(aut);
-  auto const scci = get_sccs(aut.states(), aut_suc);
-  auto const sccDet = ba_scc_classify_det(aut, scci);
-  auto const sccAcc = ba_scc_classify_acc(aut, scci);
-  assert(sccAcc.size() == scci.sccs.size());
-  int a=0;
-  int n=0;
-  int m=0;
-  for (auto const& it : sccAcc) {
-    if (it.second == -1)     n++;
-    else if (it.second == 0) m++;
-    else if (it.second == 1) a++;
+// -- service mode --
+// a request is a line with nbadet options followed by a HOA automaton.
+// the response is either "ok <N>" followed by a newline and N bytes of HOA output,
+// or a single line "error <reason>". responses come in request order.
+
+//reads requests from a file descriptor
+class RequestReader {
+  int fd;
+  string buf;
+  size_t pos = 0;
+
+  bool fill() {
+    char tmp[1 << 16];
+    ssize_t n;
+    do { n = read(fd, tmp, sizeof(tmp)); } while (n < 0 && errno == EINTR);
+    if (n <= 0)
+      return false;
+    buf.append(tmp, n);
+    return true;
   }
-  if (log)
-    log->info("SCCs: {} total = {} A + {} N + {} M, of which {} D",
-              scci.sccs.size(), a, n, m, sccDet.size());
 
-  return calc_detconfsets(dc, scci, sccAcc, sccDet);
-}
+public:
+  explicit RequestReader(int infd) : fd(infd) {}
 
-//take automaton and inclusion partial order
-//construct restricted order for optimizations
-map<unsigned, nba_bitset> sim_po_to_implmask(auto const& aut, map<unsigned, set<unsigned>> const& po, bool classic_variant) {
-  //calculate reachable states from each state
-  map<state_t, vector<state_t>> reaches;
-  for (auto const s : aut.states()) {
-    reaches[s] = reachable_states(aut, s);
+  //whether next() would not block
+  bool ready() const {
+    if (buf.find_first_not_of(" \t\r\n", pos) != string::npos)
+      return true;
+    pollfd pfd{fd, POLLIN, 0};
+    return poll(&pfd, 1, 0) > 0;
   }
 
-  map<unsigned, nba_bitset> ret;
-  for (auto const s : aut.states())
-    ret[s].set(); //mask allows everything by default
-
-  for (auto const& it : po)
-    for (auto const b : it.second) {
-      if (it.first != b) {
-        bool areachb = contains(reaches.at(it.first), b);
-        bool breacha = contains(reaches.at(b), it.first);
-
-        bool cond = false;
-        if (classic_variant) { // a < b & !reaches(b, a)
-          cond = !breacha;
-        } else { //a < b & (reaches(b, a) <-> reaches(a, b))
-          cond = areachb == breacha;
+  //returns false at end of input
+  bool next(string& opts, string& hoa) {
+    buf.erase(0, pos);
+    pos = 0;
+
+    size_t nl;
+    while (true) { //skip empty lines
+      while ((nl = buf.find('\n')) == string::npos) {
+        if (!fill()) {
+          if (buf.find_first_not_of(" \t\r\n") != string::npos)
+            throw runtime_error("Incomplete request at end of input!");
+          return false;
         }
-
-        if (cond)
-          ret[b].reset(it.first);
       }
+      if (buf.find_first_not_of(" \t\r", 0) < nl)
+        break;
+      buf.erase(0, nl+1);
     }
-
-  return ret;
-}
-
-//given args and NBA, prepare corresponding determinization config structure
-DetConf assemble_detconf(Args const& args, auto const& aut,
-                    map<unsigned,set<unsigned>> const& impl_po,
-                    shared_ptr<spdlog::logger> log = nullptr) {
-  auto dc = detconf_from_args(args);
-  dc.aut_states = to_bitset<nba_bitset>(aut.states());
-  dc.aut_acc    = to_bitset<nba_bitset>( aut.states() | ranges::view::remove_if(
-                    [&](state_t s){ return !aut.state_buchi_accepting(s); }));
-  //get adj matrix for accelerated powerset calculation
-  dc.aut_mat = get_adjmat(aut);
-
-  //get accepting sinks
-  dc.aut_asinks = 0;
-  if (args.asinks)
-    dc.aut_asinks = to_bitset<nba_bitset>(ba_get_acc_sinks(aut, log));
-
-  //default mask for language inclusion
-  if (args.dsim)
-    dc.impl_mask = sim_po_to_implmask(aut, impl_po, true);
-  if (args.prunesim)
-    dc.impl_pruning_mask = sim_po_to_implmask(aut, impl_po, false);
-
-  //calculate 2^AxA context structure and its sccs
-  if (args.context)
-    dc.ctx = get_context(aut, dc.aut_mat, dc.aut_asinks, dc.impl_mask, log);
-
-  //when under-approximation disabled, set bound so high that result is exact
-  dc.maxsets = aut.num_states() + 1;
-
-  //precompute lots of sets used in construction
-  dc.sets = get_detconfsets(aut, dc, log);
-  return dc;
-}
-
-//output stats about active priorities, numstates, SCCs, different trees overall and per powerset, etc.
-void print_stats(auto const& pa) {
-
-  unordered_map<nba_bitset, int> numsets;
-  map<pri_t, int> numpri;
-  int mx=0;
-  for (auto const st : pa.states()) {
-    if (!pa.tag.hasi(st))
-      continue;
-
-    auto const psh = pa.tag.geti(st).powerset;
-    numsets[psh]++;
-    if (mx < numsets[psh])
-      mx = numsets[psh];
-
-    for (auto const sym : pa.state_outsyms(st)) {
-      for (auto const es : pa.succ_edges(st, sym)) {
-        numpri[es.second]++;
+    opts = buf.substr(0, nl);
+
+    while (true) {
+      size_t end = nl+1;
+      string_view const chunk = next_hoa_chunk(buf, end, false);
+      if (!chunk.empty()) {
+        hoa = string(chunk);
+        pos = end;
+        return true;
       }
+      if (!fill())
+        throw runtime_error("Incomplete automaton at end of input!");
     }
   }
+};
 
-  cerr << "#states: " << pa.num_states();
-  cerr << " #psets: " << numsets.size();
-  cerr << " maxseen: " << mx << endl;
-  cerr << "prio:\t#: " << endl;
-  for (auto const it : numpri) {
-    cerr << it.first << "\t" << it.second << endl;
-  }
+//runs in a worker: parse options and automaton of request, return DPA
+string handle_request(string const& opts, string const& hoa, Args const& server,
+                      std::shared_ptr<spdlog::logger> log) {
+  //stdout may be the response channel, nothing else may end up there
+  int const devnull = open("/dev/null", O_WRONLY);
+  if (devnull >= 0)
+    dup2(devnull, STDOUT_FILENO);
+
+  auto args = parse_request_args(opts);
+  args.cache = server.cache;
+
+  auto aut = parse_hoa(hoa);
+  string const problem = input_problem(aut);
+  if (!problem.empty())
+    throw runtime_error(problem);
+  return determinize_to_hoa(args, aut, log);
 }
 
-PA process_nba(Args const &args, auto& aut, std::shared_ptr<spdlog::logger> log) {
-    // -- preprocessing --
-
-    //first trim (unmark trivial states that are accepting, remove useless+unreach SCCs)
-    // just in case... usually input is already trim
-    if (args.trim)
-      ba_trim(aut, log);
-    // aut->normalize(); //don't do this, otherwise relationship not clear anymore
-
-    map<unsigned, set<unsigned>> po;
-    if (args.dsim || args.prunesim) {
-      auto const simret = ba_direct_sim(aut);
-      aut = simret.first;
-      po = simret.second;
-      // print_aut(aut, cerr);
+//answer requests from infd on outfd using a pool of workers
+void serve_stream(int infd, int outfd, unsigned workers, Args const& args,
+                  std::shared_ptr<spdlog::logger> log) {
+  JobPool pool(workers, limits_from_args(args));
+  RequestReader in(infd);
+
+  auto const respond = [&](JobResult const& res) {
+    if (res.status == JobStatus::ok) {
+      write_all(outfd, "ok " + to_string(res.output.size()) + "\n" + res.output);
+    } else {
+      string reason = to_string(res.status);
+      if (!res.output.empty())
+        reason += ": " + res.output.substr(0, res.output.find('\n'));
+      write_all(outfd, "error " + reason + "\n");
+    }
+  };
+
+  string opts, hoa;
+  while (true) {
+    //a client may wait for responses before sending more
+    while (pool.pending() && !in.ready())
+      respond(pool.next_result());
+
+    try {
+      if (!in.next(opts, hoa))
+        break;
+    } catch (std::exception& e) {
+      log->error(e.what());
+      break;
     }
 
-    auto dc = assemble_detconf(args, aut, po, log);
-
-    if (args.verbose >= 2)
-      cerr << dc << endl;
-
-    //calculate 2^A and its sccs
-    auto const pscon = bench(log,"powerset_construction",
-                             WRAP(powerset_construction(aut, dc.aut_mat, dc.aut_asinks, dc.impl_mask)));
-    auto const pscon_scci = get_sccs(pscon.states(), aut_succ(pscon));
-    log->info("#states in 2^A: {}, #SCCs in 2^A: {}", pscon.num_states(), pscon_scci.sccs.size());
-    // print_aut(pscon);
-
-    // -- end of preprocessing --
-
-    //determinize (optionally using psets)
-    unique_ptr<PA> upa = find_min_param(args.approx ? 1 : dc.maxsets, dc.maxsets, [&](int numsets){
-      dc.maxsets = numsets;
-      if (args.approx)
-        log->info("trying approximation depth {}...", dc.maxsets);
-
-      unique_ptr<PA> pa;
-      if (!args.psets)
-        pa = bench(log, "determinize", WRAP(make_unique<PA>(determinize(aut, dc))));
-      else
-        pa = bench(log, "determinize_with_psets", WRAP(make_unique<PA>(determinize(aut, dc, pscon, pscon_scci))));
-
-      if (args.stats) { //show stats before postprocessing
-        print_stats(*pa);
-      }
-
-      // -- begin postprocessing --
-      if (args.mindfa) {
-        auto optlog = args.verbose>1 ? log : nullptr;
-        log->info("#priorities before: {}", pa->pris().size());
-        log->info("#states before: {}", pa->states().size());
+    pool.submit([&]() { return handle_request(opts, hoa, args, log); });
+    while (pool.has_result())
+      respond(pool.next_result());
+  }
 
-        pa->make_colored();
-        bench(log, "minimize number of priorities", WRAP(minimize_priorities(*pa, optlog)));
-        log->info("#priorities after: {}", pa->pris().size());
+  while (pool.pending())
+    respond(pool.next_result());
+}
 
-        pa->make_complete();
-        bench(log, "minimize number of states", WRAP(minimize_pa(*pa, optlog)));
-        log->info("#states after: {}", pa->num_states());
-      }
-      // -- end of postprocessing --
+//accept connections on UNIX domain socket, each is served by its own process
+//with requests processed one by one, at most args.jobs connections at once
+void serve_socket(Args const& args, std::shared_ptr<spdlog::logger> log) {
+  sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  if (args.socket.size() >= sizeof(addr.sun_path))
+    throw runtime_error("Socket path too long!");
+  strcpy(addr.sun_path, args.socket.c_str());
+
+  int const sock = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  unlink(args.socket.c_str());
+  if (sock < 0 || bind(sock, (sockaddr*)&addr, sizeof(addr)) != 0 || listen(sock, 64) != 0)
+    throw runtime_error("Can not listen on " + args.socket + ": " + strerror(errno) + "!");
+  log->info("listening on {}", args.socket);
+
+  JobPool conns(args.jobs, JobLimits());
+  while (true) {
+    int const conn = accept(sock, nullptr, nullptr);
+    if (conn < 0) {
+      if (errno == EINTR || errno == ECONNABORTED)
+        continue;
+      throw runtime_error(string("accept failed: ") + strerror(errno) + "!");
+    }
 
-      //this automaton is not accepting the whole language of BA
-      if (args.approx && !ba_dpa_inclusion(aut, *pa))
-        return unique_ptr<PA>(nullptr);
+    //clean up after closed connections, not only when all slots are taken
+    conns.reap();
+    while (conns.has_result())
+      conns.next_result();
 
-      return pa;
+    conns.submit([&]() {
+      close(sock);
+      serve_stream(conn, conn, 1, args, log);
+      return string();
     });
-
-    assert(upa);
-    PA& pa = *(upa.get());
-
-    //sanity checks
-    assert(pa.get_name() == aut.get_name());
-    assert(pa.get_aps() == aut.get_aps());
-    assert(pa.is_deterministic());
-
-    if (args.stats) { //show stats after postprocessing
-      print_stats(pa);
-    }
-
-    return pa;
+    close(conn);
+  }
 }
 
 int main(int argc, char *argv[]) {
@@ -464,37 +330,74 @@ int main(int argc, char *argv[]) {
 
   auto const totalstarttime = get_time();
 
-  // now parse input automata:
-  auto auts = nbautils::AutStream<Aut<string>>(args.file, log);
-  while (auts.has_next()) {
-    auto aut = auts.parse_next();
+  //with stats, memory and time per phase is reported at the end
+  if (!args.profile.empty() || !args.profile_trace.empty() || args.stats)
+    Profiler::get().enable(!args.profile_trace.empty());
 
-    log->info("NBA name: \"{}\", #states: {}, #APs: {} #Syms: {}",
-              aut.get_name(), aut.num_states(), aut.get_aps().size(), aut.num_syms());
+  set_progress_fd(args.progress_fd);
+  set_progress_interval(args.progress_interval);
+  if (args.verbose)
+    set_progress_log(log);
 
-    // sanity of the input
-    if (!aut.is_buchi()) {
-      log->error("This is not an NBA!");
+  if (!args.cache.empty()) {
+    try {
+      ResultCache const cache(args.cache);
+    } catch (std::exception& e) {
+      log->error(e.what());
       exit(1);
     }
-    if (aut.num_states() > max_nba_states) {
-      log->error("NBA is way too large, I refuse.");
+  }
+
+  if (args.serve) {
+    try {
+      if (args.socket.empty())
+        serve_stream(STDIN_FILENO, STDOUT_FILENO, args.jobs, args, log);
+      else
+        serve_socket(args, log);
+    } catch (std::exception& e) {
+      log->error(e.what());
       exit(1);
     }
-    if (aut.get_aps().size() > max_nba_syms) {
-      log->error("Alphabet is way too large, I refuse.");
-      exit(1);
+    return 0;
+  }
+
+  int exitcode = 0; //3 = some automaton exceeded the resource limits
+
+  // now parse input automata:
+  auto auts = nbautils::HOAStream(args.file, log);
+  if (args.jobs || args.timeout || args.memory) {
+    exitcode = process_batch(args, auts, log);
+  } else {
+    while (auts.has_next()) {
+      auto aut = auts.parse_next();
+      check_input(aut, log);
+
+      // NBA -> DPA
+      try {
+        cout << determinize_to_hoa(args, aut, log) << flush;
+      } catch (BudgetExceeded const& e) {
+        log->error("\"{}\": {}", aut.get_name(), e.what());
+        exitcode = 3;
+      }
     }
+  }
 
-    // NBA -> DPA
-    PA const pa = bench(log,"process_nba",
-                          WRAP(process_nba(args, aut, log)));
+  if (!args.profile.empty()) {
+    ofstream out(args.profile);
+    Profiler::get().write_json(out);
+  }
+  if (!args.profile_trace.empty()) {
+    ofstream out(args.profile_trace);
+    Profiler::get().write_trace(out);
+  }
 
-    if (!args.nooutput)
-      print_aut(pa);
+  if (args.stats) {
+    Profiler::get().write_summary(cerr);
+    print_mem_stats(cerr);
   }
 
   log->info("total time: {:.3f} seconds", get_secs_since(totalstarttime));
   log->info("total used memory: {:.3f} MB", (double)getPeakRSS() / (1024 * 1024));
+  return exitcode;
 }
 
@@ -0,0 +1,760 @@
+#pragma once
+
+#include <iostream>
+#include <sstream>
+#include <set>
+#include <string>
+#include <vector>
+#include <cassert>
+
+#include <spdlog/spdlog.h>
+#include <args.hxx>
+
+#include "metrics/bench.hh"
+#include "metrics/profiler.hh"
+
+#include "aut.hh"
+#include "io.hh"
+#include "graph.hh"
+#include "common/scc.hh"
+#include "ps.hh"
+#include "pa.hh"
+#include "preproc.hh"
+#include "detstate.hh"
+#include "det.hh"
+#include "cache.hh"
+
+//option handling and determinization pipeline of nbadet,
+//shared with tools running nbadet configurations in-process (e.g. nbadet-bench)
+
+namespace nbautils {
+using namespace std;
+
+struct Args {
+  string file;
+
+  int verbose;
+  bool stats;
+  bool nooutput;
+
+  int jobs;
+  double timeout;
+  int memory;
+
+  bool serve;
+  string socket;
+
+  string cache;
+
+  string profile;
+  string profile_trace;
+
+  int progress_fd;
+  double progress_interval;
+
+  int max_states;
+  int max_memory;
+  double time_budget;
+  vector<string> fallback;
+  bool has_deadline = false; //set when processing of an automaton starts
+  timepoint_t deadline;
+
+  string checkpoint;
+  double checkpoint_interval;
+  bool resume;
+
+  string out_of_core;
+
+  bool trim;
+  bool asinks;
+  bool dsim;
+  bool prunesim;
+  bool mindfa;
+
+  int mergemode;
+  bool puretrees;
+
+  bool psets;
+  bool context;
+  bool approx;
+
+  bool seprej;
+  bool sepacc;
+  bool cyclicbrk;
+  bool sepmix;
+  bool optdet;
+  bool optsuc;
+  bool hitset;
+
+  bool z; //for experimental behaviour, no fixed meaning
+};
+
+//with request set (service mode), invalid options throw instead of exiting
+inline Args parse_args(int argc, char *argv[], bool request = false) {
+  args::ArgumentParser parser("nbadet - determinize nondeterministic Büchi automata", "");
+  args::HelpFlag help(parser, "help", "Display this help menu", {'h', "help"});
+
+  args::Positional<string> input(parser, "INPUTFILE",
+      "file containing the NBA(s) (if none given, uses <stdin>)");
+
+  // introspection and debugging
+  args::CounterFlag verbose(parser, "verbose", "Show verbose information",
+      {'v', "verbose"}); // logging level -v, -vv, etc.
+  args::CounterFlag stats(parser, "stats", "Output stats about structure",
+      {'s', "output-stats"});
+  args::Flag nooutput(parser, "nooutput", "Do not print resulting automaton",
+      {'x', "no-output"});
+
+  // batch processing
+  args::ValueFlag<int> jobs(parser, "N", "Process automata in N parallel worker processes",
+      {"jobs"});
+  args::ValueFlag<double> timeout(parser, "SECS", "Give up on an automaton after SECS seconds",
+      {"timeout"});
+  args::ValueFlag<int> memory(parser, "MB", "Give up on an automaton using more than MB megabytes",
+      {"memory"});
+
+  // service mode
+  args::Flag serve(parser, "serve", "Answer requests (option line + HOA automaton) from stdin",
+      {"serve"});
+  args::ValueFlag<string> socket(parser, "PATH", "Answer requests on UNIX domain socket PATH",
+      {"socket"});
+
+  // profiling
+  args::ValueFlag<string> profile(parser, "FILE", "Write aggregated time per phase as JSON to FILE",
+      {"profile"});
+  args::ValueFlag<string> profile_trace(parser, "FILE", "Write phases in Chrome trace format to FILE",
+      {"profile-trace"});
+
+  // live progress
+  args::ValueFlag<int> progress_fd(parser, "FD", "Write progress snapshots as JSON lines to file descriptor FD",
+      {"progress-fd"}, -1);
+  args::ValueFlag<double> progress_interval(parser, "SECS", "Seconds between progress snapshots (default: 1)",
+      {"progress-interval"}, 1.0);
+
+  // resource limits for determinization
+  args::ValueFlag<int> max_states(parser, "N", "Abort determinization with more than N states",
+      {"max-states"});
+  args::ValueFlag<int> max_memory(parser, "MB", "Abort determinization using more than MB megabytes",
+      {"max-memory"});
+  args::ValueFlag<double> time_budget(parser, "SECS", "Abort determinization of an automaton after SECS seconds",
+      {"time-budget"});
+  args::ValueFlag<string> fallback(parser, "STEPS", "On abort, retry after each of the comma-separated "
+      "steps: noopt (no -o -m), u0/u1/u2 (update mode), approx (-p)",
+      {"fallback"});
+
+  // checkpointing
+  args::ValueFlag<string> checkpoint(parser, "FILE", "Periodically save state of determinization to FILE",
+      {"checkpoint"});
+  args::ValueFlag<double> checkpoint_interval(parser, "SECS", "Seconds between checkpoints (default: 600)",
+      {"checkpoint-interval"}, 600);
+  args::Flag resume(parser, "resume", "Continue determinization from checkpoint (if it exists)",
+      {"resume"});
+
+  args::ValueFlag<string> out_of_core(parser, "DIR",
+      "Keep states on disk in DIR during determinization (for very large outputs)",
+      {"out-of-core"});
+
+  // result caching
+  args::ValueFlag<string> cache(parser, "DIR", "Reuse results for isomorphic inputs stored in DIR",
+      {"cache"});
+
+  // preprocessing on NBA (known, simple stuff)
+  args::Flag trim(parser, "trim", "Kill dead states from NBA.",
+      {'k', "trim"});
+  args::Flag asinks(parser, "asinks", "Detect and use accepting (pseudo)sinks.",
+      {'j', "acc-sinks"});
+  args::Flag dsim(parser, "dsim", "Use direct simulation for preprocessing and optimization.",
+      {'i', "dir-sim"});
+  args::Flag prunesim(parser, "prunesim", "Use direct simulation to prune trees heuristically.",
+      {'r', "prune-sim"});
+  args::Flag approx(parser, "underapprox", "Iteratively underapproximate the Safra trees.",
+      {'p', "approx"});
+  args::Flag optsuc(parser, "optsuc", "Optimize successor selection using existing states if possible.",
+      {'o', "opt-succ"});
+  args::Flag hitset(parser, "hitset-opt", "Optimize using hitset calculation.",
+      {'q', "hitset"});
+
+  // postprocessing
+  args::Flag mindfa(parser, "mindfa", "First minimize number of priorities, "
+      "then minimize number of states using Hopcroft",
+      {'m', "minimize-dfa"});
+
+  // type of update for active ranks
+  args::ValueFlag<int> mergemode(parser, "N", "Type of update "
+      "(0=Muller/Schupp, 1=Safra, 2=Maximal merge)",
+      {'u', "update-mode"});
+  args::Flag puretrees(parser, "pure", "Accepting leaf normal form (acc. states in leaves only)",
+      {'l', "pure-trees"});
+
+  // used to weed out redundant SCCs in det. automaton
+  args::Flag psets(parser, "powersets", "Use powerset SCCs to guide determinization",
+      {'t', "use-powersets"});
+
+  // additional calculations on NBA to optimize construction
+  args::Flag context(parser, "context", "Calculate context for separation refinement",
+      {'c', "use-context"});
+
+  // enabled optimizations for Safra/Level update
+  args::Flag seprej(parser, "seprej", "Separate states in non-accepting SCCs",
+      {'n', "sep-rej"});
+  args::Flag sepacc(parser, "sepacc", "Separate states in accepting SCCs",
+      {'a', "sep-acc"});
+  args::Flag cyclicbrk(parser, "cyclicbrk", "Separate states in accepting SCCs, cycle through SCCs",
+      {'b', "cyclic-breakpoint"});
+  args::Flag sepmix(parser, "sepmix", "Separate states in different SCCs",
+      {'e', "sep-mix"});
+  args::Flag optdet(parser, "optdet", "Optimize deterministic SCCs by not expanding trees",
+      {'d', "opt-det"});
+
+  // ----
+  // args::Flag z(parser, "z", "Surprise!", {'z', "z"}); //NOTE: this should be commented out in commits
+  bool z = false; //dummy flag, always false
+  // ----
+
+  // NOTES:
+  // strictly good and cheap optimizations are: -k, -t, -j, -i, -r
+  // mostly good, seldom bad and cheap: -n -a -b -d -e -l
+  // usually very good and sometimes slightly more expensive: -o -q
+  // very good and very expensive: -m
+  // usually the best update mode is: -u1
+  //
+  // some "bad" LTL formulas witnessed negative interactions of:
+  // (-e or -d) and -i (slight state increase)
+  // -l and -r (significant increase)
+  // but overall all contribute positive on average
+  //
+  // it may be that together -o and -t are not as effective as on their own
+  // TODO:
+  // this MAYBE can be remedied by changing the way -t works s.t. exploration
+  // is started from a "real" successor instead of just the powerset
+  //
+  // The underapproximation (-p) and context (-c) empirically have
+  // never shown positive and sometimes even negative effect
+  // and therefore should not be used.
+
+  auto const fail = [request](string const& msg) {
+    if (request)
+      throw runtime_error(msg);
+    spdlog::get("log")->error(msg);
+    exit(1);
+  };
+
+  try {
+    parser.ParseCLI(argc, argv);
+  } catch (args::Help&) {
+    if (request)
+      throw runtime_error("Option not allowed in requests: --help");
+    std::cout << parser;
+    exit(0);
+  } catch (args::ParseError& e) {
+    if (request)
+      throw runtime_error(e.what());
+    cerr << e.what() << endl << parser;
+    exit(1);
+  } catch (args::ValidationError& e) {
+    if (request)
+      throw runtime_error(e.what());
+    cerr << e.what() << endl << parser;
+    exit(1);
+  }
+
+  if (context && !(seprej || sepacc)) {
+    fail("-c without at least one of -a or -n is useless!");
+  }
+
+  if (context && optsuc) {
+    fail("-c does not work with -o!");
+  }
+
+  if (cyclicbrk && !sepacc) {
+    fail("-b without -a is useless!");
+  }
+
+  if (mergemode && args::get(mergemode) >= static_cast<int>(UpdateMode::num)) {
+    fail("Invalid update mode provided: " + to_string(args::get(mergemode)));
+  }
+
+  if ((jobs && args::get(jobs) < 0) || (timeout && args::get(timeout) < 0)
+      || (memory && args::get(memory) < 0)) {
+    fail("--jobs, --timeout and --memory must not be negative!");
+  }
+
+  if (args::get(max_states) < 0 || args::get(max_memory) < 0 || args::get(time_budget) < 0) {
+    fail("--max-states, --max-memory and --time-budget must not be negative!");
+  }
+
+  if (resume && !checkpoint) {
+    fail("--resume requires --checkpoint!");
+  }
+
+  if (checkpoint && (psets || approx || serve || socket || (jobs && args::get(jobs) > 1))) {
+    fail("--checkpoint does not work with -t, -p, --jobs or service mode!");
+  }
+
+  if (out_of_core && (psets || approx || optsuc || hitset || mindfa || stats || fallback || cache
+                      || checkpoint || serve || socket || (jobs && args::get(jobs) > 1))) {
+    fail("--out-of-core does not work with -t, -p, -o, -q, -m, -s, "
+         "--fallback, --cache, --checkpoint, --jobs or service mode!");
+  }
+
+  vector<string> fallback_steps;
+  {
+    stringstream ss(args::get(fallback));
+    string step;
+    while (getline(ss, step, ',')) {
+      if (step != "noopt" && step != "u0" && step != "u1" && step != "u2" && step != "approx")
+        fail("Invalid fallback step provided: " + step);
+      fallback_steps.push_back(step);
+    }
+  }
+
+  //fill args
+  Args args;
+  if (input) {
+    string filename = args::get(input);
+    ifstream exists(filename);
+    if (!exists) {
+      spdlog::get("log")->error("File does not exist: {}", filename);
+    }
+    args.file = filename;
+  }
+
+  args.verbose = args::get(verbose);
+  args.stats = stats;
+  args.nooutput = nooutput;
+
+  args.jobs = args::get(jobs);
+  args.timeout = args::get(timeout);
+  args.memory = args::get(memory);
+
+  args.serve = serve || socket;
+  args.socket = args::get(socket);
+
+  args.cache = args::get(cache);
+
+  args.profile = args::get(profile);
+  args.profile_trace = args::get(profile_trace);
+
+  args.progress_fd = args::get(progress_fd);
+  args.progress_interval = args::get(progress_interval);
+
+  args.max_states = args::get(max_states);
+  args.max_memory = args::get(max_memory);
+  args.time_budget = args::get(time_budget);
+  args.fallback = fallback_steps;
+
+  args.checkpoint = args::get(checkpoint);
+  args.checkpoint_interval = args::get(checkpoint_interval);
+  args.resume = resume;
+
+  args.out_of_core = args::get(out_of_core);
+
+  args.trim = trim;
+  args.asinks = asinks;
+  args.dsim = dsim;
+  args.prunesim = prunesim;
+  args.mindfa = mindfa;
+
+  args.psets = psets;
+  args.context = context;
+  args.approx = approx;
+
+  args.mergemode = args::get(mergemode);
+  args.puretrees = puretrees;
+
+  args.seprej = seprej;
+  args.sepacc = sepacc;
+  args.cyclicbrk = cyclicbrk;
+  args.sepmix = sepmix;
+  args.optdet = optdet;
+
+  args.optsuc = optsuc;
+  args.hitset = hitset;
+
+  args.z = z;
+
+  return args;
+}
+
+//all options that influence the resulting automaton
+inline string options_key(Args const& args) {
+  stringstream ss;
+  ss << "nbadet"
+     << " k" << args.trim << " j" << args.asinks << " i" << args.dsim << " r" << args.prunesim
+     << " m" << args.mindfa << " u" << args.mergemode << " l" << args.puretrees
+     << " t" << args.psets << " c" << args.context << " p" << args.approx
+     << " n" << args.seprej << " a" << args.sepacc << " b" << args.cyclicbrk
+     << " e" << args.sepmix << " d" << args.optdet << " o" << args.optsuc
+     << " q" << args.hitset << " z" << args.z;
+  return ss.str();
+}
+
+//fill DetConf flags from args
+inline DetConf detconf_from_args(Args const& args) {
+  DetConf dc;
+
+  dc.debug = args.verbose > 2;
+
+  dc.update = static_cast<UpdateMode>(args.mergemode);
+  dc.puretrees = args.puretrees;
+
+  dc.sep_rej = args.seprej;
+  dc.sep_acc = args.sepacc;
+  dc.sep_acc_cyc = args.cyclicbrk;
+  dc.sep_mix = args.sepmix;
+  dc.opt_det = args.optdet;
+
+  dc.opt_suc = args.optsuc;
+  dc.hitset = args.hitset;
+
+  dc.z = args.z;
+
+  dc.max_states = args.max_states;
+  dc.max_memory = static_cast<size_t>(args.max_memory) * 1024 * 1024;
+  dc.has_deadline = args.has_deadline;
+  dc.deadline = args.deadline;
+
+  dc.checkpoint = args.checkpoint;
+  dc.checkpoint_interval = args.checkpoint_interval;
+  dc.resume = args.resume;
+
+  return dc;
+}
+
+//given NBA and detconf without sets, return the corresponding configured sets
+DetConfSets get_detconfsets(auto const& aut, DetConf const& dc,
+                    shared_ptr<spdlog::logger> log = nullptr) {
+  auto const aut_suc = aut_succ(aut);
+  auto const scci = get_sccs(aut.states(), aut_suc);
+  auto const sccDet = ba_scc_classify_det(aut, scci);
+  auto const sccAcc = ba_scc_classify_acc(aut, scci);
+  assert(sccAcc.size() == scci.sccs.size());
+  int a=0;
+  int n=0;
+  int m=0;
+  for (auto const& it : sccAcc) {
+    if (it.second == -1)     n++;
+    else if (it.second == 0) m++;
+    else if (it.second == 1) a++;
+  }
+  if (log)
+    log->info("SCCs: {} total = {} A + {} N + {} M, of which {} D",
+              scci.sccs.size(), a, n, m, sccDet.size());
+
+  return calc_detconfsets(dc, scci, sccAcc, sccDet);
+}
+
+//take automaton and inclusion partial order
+//construct restricted order for optimizations
+map<unsigned, nba_bitset> sim_po_to_implmask(auto const& aut, map<unsigned, set<unsigned>> const& po, bool classic_variant) {
+  //reachability between all states
+  auto const reach = reach_index(aut);
+
+  map<unsigned, nba_bitset> ret;
+  for (auto const s : aut.states())
+    ret[s].set(); //mask allows everything by default
+
+  for (auto const& it : po)
+    for (auto const b : it.second) {
+      if (it.first != b) {
+        bool const areachb = reach.reaches(it.first, b);
+        bool const breacha = reach.reaches(b, it.first);
+
+        bool cond = false;
+        if (classic_variant) { // a < b & !reaches(b, a)
+          cond = !breacha;
+        } else { //a < b & (reaches(b, a) <-> reaches(a, b))
+          cond = areachb == breacha;
+        }
+
+        if (cond)
+          ret[b].reset(it.first);
+      }
+    }
+
+  return ret;
+}
+
+//given args and NBA, prepare corresponding determinization config structure
+DetConf assemble_detconf(Args const& args, auto const& aut,
+                    map<unsigned,set<unsigned>> const& impl_po,
+                    shared_ptr<spdlog::logger> log = nullptr) {
+  PROF_PHASE("detconf");
+  auto dc = detconf_from_args(args);
+  dc.aut_states = to_bitset<nba_bitset>(aut.states());
+  dc.aut_acc    = to_bitset<nba_bitset>( aut.states() | ranges::view::remove_if(
+                    [&](state_t s){ return !aut.state_buchi_accepting(s); }));
+  //get adj matrix for accelerated powerset calculation
+  dc.aut_mat = get_adjmat(aut);
+
+  //get accepting sinks
+  dc.aut_asinks = 0;
+  if (args.asinks)
+    dc.aut_asinks = to_bitset<nba_bitset>(ba_get_acc_sinks(aut, log));
+
+  //default mask for language inclusion
+  if (args.dsim)
+    dc.impl_mask = sim_po_to_implmask(aut, impl_po, true);
+  if (args.prunesim)
+    dc.impl_pruning_mask = sim_po_to_implmask(aut, impl_po, false);
+
+  //calculate 2^AxA context structure and its sccs
+  if (args.context)
+    dc.ctx = get_context(aut, dc.aut_mat, dc.aut_asinks, dc.impl_mask, log);
+
+  //when under-approximation disabled, set bound so high that result is exact
+  dc.maxsets = aut.num_states() + 1;
+
+  //precompute lots of sets used in construction
+  dc.sets = get_detconfsets(aut, dc, log);
+  return dc;
+}
+
+//output stats about active priorities, numstates, SCCs, different trees overall and per powerset, etc.
+void print_stats(auto const& pa) {
+
+  unordered_map<nba_bitset, int> numsets;
+  map<pri_t, int> numpri;
+  int mx=0;
+  for (auto const st : pa.states()) {
+    if (!pa.tag.hasi(st))
+      continue;
+
+    auto const psh = pa.tag.geti(st).powerset;
+    numsets[psh]++;
+    if (mx < numsets[psh])
+      mx = numsets[psh];
+
+    for (auto const sym : pa.state_outsyms(st)) {
+      for (auto const es : pa.succ_edges(st, sym)) {
+        numpri[es.second]++;
+      }
+    }
+  }
+
+  cerr << "#states: " << pa.num_states();
+  cerr << " #psets: " << numsets.size();
+  cerr << " maxseen: " << mx << endl;
+  cerr << "prio:\t#: " << endl;
+  for (auto const it : numpri) {
+    cerr << it.first << "\t" << it.second << endl;
+  }
+}
+
+//preprocess the NBA (modified in place) and assemble the DetConf for it
+DetConf preprocess_nba(Args const &args, auto& aut, std::shared_ptr<spdlog::logger> log) {
+    //first trim (unmark trivial states that are accepting, remove useless+unreach SCCs)
+    // just in case... usually input is already trim
+    if (args.trim) {
+      PROF_PHASE("trim");
+      ba_trim(aut, log);
+    }
+    // aut->normalize(); //don't do this, otherwise relationship not clear anymore
+
+    map<unsigned, set<unsigned>> po;
+    if (args.dsim || args.prunesim) {
+      PROF_PHASE("dsim");
+      auto const simret = ba_direct_sim(aut);
+      aut = simret.first;
+      po = simret.second;
+      // print_aut(aut, cerr);
+    }
+
+    auto dc = assemble_detconf(args, aut, po, log);
+    if (!args.checkpoint.empty())
+      dc.checkpoint_key = options_key(args) + "\n" + structure_key(aut);
+
+    if (args.verbose >= 2)
+      cerr << dc << endl;
+    return dc;
+}
+
+PA process_nba(Args const &args, auto& aut, std::shared_ptr<spdlog::logger> log) {
+    // -- preprocessing --
+    auto dc = preprocess_nba(args, aut, log);
+
+    //calculate 2^A and its sccs
+    auto const psres = bench(log,"powerset_construction",
+                             WRAP(powerset_construction_sccs(aut, dc.aut_mat, dc.aut_asinks, dc.impl_mask)));
+    auto const& pscon = psres.first;
+    auto const& pscon_scci = psres.second;
+    log->info("#states in 2^A: {}, #SCCs in 2^A: {}", pscon.num_states(), pscon_scci.sccs.size());
+    // print_aut(pscon);
+
+    // -- end of preprocessing --
+
+    //determinize (optionally using psets)
+    unique_ptr<PA> upa = find_min_param(args.approx ? 1 : dc.maxsets, dc.maxsets, [&](int numsets){
+      dc.maxsets = numsets;
+      if (args.approx)
+        log->info("trying approximation depth {}...", dc.maxsets);
+
+      unique_ptr<PA> pa;
+      if (!args.psets)
+        pa = bench(log, "determinize", WRAP(make_unique<PA>(determinize(aut, dc))));
+      else
+        pa = bench(log, "determinize_with_psets", WRAP(make_unique<PA>(determinize(aut, dc, pscon, pscon_scci))));
+
+      if (args.stats) { //show stats before postprocessing
+        print_stats(*pa);
+      }
+
+      // -- begin postprocessing --
+      if (args.mindfa) {
+        auto optlog = args.verbose>1 ? log : nullptr;
+        log->info("#priorities before: {}", pa->pris().size());
+        log->info("#states before: {}", pa->states().size());
+
+        pa->make_colored();
+        bench(log, "minimize number of priorities", WRAP(minimize_priorities(*pa, optlog)));
+        log->info("#priorities after: {}", pa->pris().size());
+
+        pa->make_complete();
+        bench(log, "minimize number of states", WRAP(minimize_pa(*pa, optlog)));
+        log->info("#states after: {}", pa->num_states());
+      }
+      // -- end of postprocessing --
+
+      //this automaton is not accepting the whole language of BA
+      if (args.approx && !ba_dpa_inclusion(aut, *pa))
+        return unique_ptr<PA>(nullptr);
+
+      return pa;
+    });
+
+    assert(upa);
+    PA& pa = *(upa.get());
+
+    //sanity checks
+    assert(pa.get_name() == aut.get_name());
+    assert(pa.get_aps() == aut.get_aps());
+    assert(pa.is_deterministic());
+
+    if (args.stats) { //show stats after postprocessing
+      print_stats(pa);
+    }
+
+    return pa;
+}
+
+//apply one step of the fallback policy to the options
+inline void apply_fallback(Args& args, string const& step) {
+  if (step == "noopt") {
+    args.optsuc = false;
+    args.mindfa = false;
+  } else if (step == "approx") {
+    args.approx = true;
+  } else if (step.size() == 2 && step[0] == 'u') {
+    args.mergemode = step[1] - '0';
+  }
+}
+
+//process_nba within the configured resource limits. when they are exceeded,
+//retry on the original input with the fallback steps applied one after another
+//(the time budget is shared by all attempts). rethrows if no step is left.
+//if given, the number of applied fallback steps is stored in fallbacks
+PA process_nba_with_fallback(Args const& args, auto const& aut,
+                             std::shared_ptr<spdlog::logger> log, size_t* fallbacks = nullptr) {
+  Args cur = args;
+  if (args.time_budget > 0) {
+    cur.has_deadline = true;
+    cur.deadline = get_time() + std::chrono::duration_cast<duration_t>(
+                     std::chrono::duration<double>(args.time_budget));
+  }
+
+  for (size_t i = 0; ; i++) {
+    auto input = aut;
+    try {
+      PA pa = process_nba(cur, input, log);
+      if (fallbacks)
+        *fallbacks = i;
+      return pa;
+    } catch (BudgetExceeded const& e) {
+      if (i >= args.fallback.size())
+        throw;
+      log->warn("\"{}\": {}, retrying with fallback {}", aut.get_name(), e.what(), args.fallback[i]);
+      apply_fallback(cur, args.fallback[i]);
+    }
+  }
+}
+
+//returns why the automaton can not be handled (empty if it is fine)
+string input_problem(auto const& aut) {
+  // sanity of the input
+  if (!aut.is_buchi())
+    return "This is not an NBA!";
+  if (aut.num_states() > max_nba_states)
+    return "NBA is way too large, I refuse.";
+  if (aut.get_aps().size() > max_nba_syms)
+    return "Alphabet is way too large, I refuse.";
+  return "";
+}
+
+//exits if the automaton can not be handled
+void check_input(auto const& aut, std::shared_ptr<spdlog::logger> log) {
+  log->info("NBA name: \"{}\", #states: {}, #APs: {} #Syms: {}",
+            aut.get_name(), aut.num_states(), aut.get_aps().size(), aut.num_syms());
+
+  string const problem = input_problem(aut);
+  if (!problem.empty()) {
+    log->error(problem);
+    exit(1);
+  }
+}
+
+//parse a line of nbadet options (as given on the command line)
+inline Args parse_args_line(string const& opts, bool request = false) {
+  vector<string> words{"nbadet"};
+  stringstream ss(opts);
+  string w;
+  while (ss >> w)
+    words.push_back(w);
+  vector<char*> argv;
+  for (auto& it : words)
+    argv.push_back(&it[0]);
+  return parse_args(argv.size(), argv.data(), request);
+}
+
+//parse the option line of a service request. only options of the construction itself
+//(those in options_key and the determinization limits) are allowed, everything touching
+//files, processes or the server itself is rejected.
+inline Args parse_request_args(string const& opts) {
+  static string const flags = "kjirpoqmltcnabed"; //u takes a value
+  static set<string> const longflags = {
+    "trim", "acc-sinks", "dir-sim", "prune-sim", "approx", "opt-succ", "hitset",
+    "minimize-dfa", "pure-trees", "use-powersets", "use-context",
+    "sep-rej", "sep-acc", "cyclic-breakpoint", "sep-mix", "opt-det" };
+  static set<string> const longvals = {
+    "update-mode", "max-states", "max-memory", "time-budget" };
+
+  stringstream ss(opts);
+  string w;
+  while (ss >> w) {
+    bool needval = false;
+    if (w.size() > 2 && w.compare(0, 2, "--") == 0) {
+      size_t const eq = w.find('=');
+      string const name = w.substr(2, eq == string::npos ? string::npos : eq-2);
+      if (longvals.count(name))
+        needval = eq == string::npos;
+      else if (!longflags.count(name) || eq != string::npos)
+        throw runtime_error("Option not allowed in requests: " + w);
+    } else if (w.size() > 1 && w[0] == '-') {
+      for (size_t i = 1; i < w.size(); i++) {
+        if (w[i] == 'u') { //value is rest of the word or the next word
+          needval = i+1 == w.size();
+          break;
+        }
+        if (flags.find(w[i]) == string::npos)
+          throw runtime_error("Option not allowed in requests: " + w);
+      }
+    } else {
+      throw runtime_error("Unexpected argument in request: " + w);
+    }
+    if (needval && !(ss >> w))
+      throw runtime_error("Missing value in request options!");
+  }
+
+  return parse_args_line(opts, true);
+}
+
+}  // namespace nbautils
@@ -0,0 +1,341 @@
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <array>
+#include <unordered_set>
+#include <algorithm>
+#include <iomanip>
+using namespace std;
+
+#include <dirent.h>
+
+#include <spdlog/spdlog.h>
+namespace spd = spdlog;
+#include <args.hxx>
+
+#include "metrics/profiler.hh"
+#include "metrics/memstats.hh"
+
+#include "aut.hh"
+#include "io.hh"
+#include "hoa_reader.hh"
+#include "common/scc.hh"
+#include "common/trie_map.hh"
+#include "ps.hh"
+#include "pa.hh"
+#include "preproc.hh"
+#include "detstate.hh"
+#include "det.hh"
+
+using namespace nbautils;
+
+//nbautils-bench - microbenchmarks of the core kernels over a corpus of NBAs.
+//every kernel is repeated until the minimal time is reached, the inputs are
+//fixed samples derived from the automaton (no randomness), so runs are comparable.
+//allocations per operation are only available with cmake -Dnbautils-alloc-stats=ON.
+
+struct Args {
+  vector<string> files;
+  string filter;
+  double min_time;
+  int sample;
+  bool csv;
+};
+
+Args parse_args(int argc, char *argv[]) {
+  args::ArgumentParser parser("nbautils-bench - microbenchmarks of the core kernels", "");
+  args::HelpFlag help(parser, "help", "Display this help menu", {'h', "help"});
+
+  args::PositionalList<string> files(parser, "FILES",
+      "HOA files with NBAs (if none given, uses the bench/ directory of the source tree)");
+
+  args::ValueFlag<string> filter(parser, "STR", "Only run kernels whose name contains STR",
+      {'f', "filter"}, "");
+  args::ValueFlag<double> min_time(parser, "SECS", "Minimal time per kernel and input (default: 0.2)",
+      {'t', "min-time"}, 0.2);
+  args::ValueFlag<int> sample(parser, "N", "Maximal number of sampled states per input (default: 1000)",
+      {'n', "sample"}, 1000);
+  args::Flag csv(parser, "csv", "Output results as CSV",
+      {"csv"});
+
+  try {
+    parser.ParseCLI(argc, argv);
+  } catch (args::Help&) {
+    std::cout << parser;
+    exit(0);
+  } catch (args::ParseError& e) {
+    std::cerr << e.what() << std::endl;
+    std::cerr << parser;
+    exit(1);
+  } catch (args::ValidationError& e) {
+    std::cerr << e.what() << std::endl;
+    std::cerr << parser;
+    exit(1);
+  }
+
+  Args args;
+  args.files = args::get(files);
+  args.filter = args::get(filter);
+  args.min_time = args::get(min_time);
+  args.sample = args::get(sample);
+  args.csv = csv;
+  return args;
+}
+
+//all .hoa files in a directory, sorted
+vector<string> hoa_files_in(string const& dir) {
+  vector<string> ret;
+  DIR* d = opendir(dir.c_str());
+  if (!d)
+    throw runtime_error("cannot open directory " + dir + "!");
+  while (auto const* ent = readdir(d)) {
+    string const name = ent->d_name;
+    if (name.size() > 4 && name.substr(name.size()-4) == ".hoa")
+      ret.push_back(dir + "/" + name);
+  }
+  closedir(d);
+  sort(begin(ret), end(ret));
+  return ret;
+}
+
+//prevent the compiler from optimizing away a result
+template <typename T>
+inline void keep(T const& x) {
+  asm volatile("" : : "r"(&x) : "memory");
+}
+
+struct BenchResult {
+  string kernel;
+  string input;
+  uint64_t ops;
+  double ns_per_op;
+  double allocs_per_op;
+};
+
+class Runner {
+  Args const& args;
+  vector<BenchResult> results;
+
+public:
+  explicit Runner(Args const& a) : args(a) {}
+
+  bool wanted(string const& kernel) const {
+    return kernel.find(args.filter) != string::npos;
+  }
+
+  //f performs ops_per_call operations. repeat with doubling counts until min_time is reached
+  template <typename F>
+  void run(string const& kernel, string const& input, uint64_t ops_per_call, F f) {
+    if (!wanted(kernel) || ops_per_call == 0)
+      return;
+
+    f(); //warm up caches and lazily computed stuff
+
+    uint64_t calls = 0;
+    uint64_t reps = 1;
+    double secs = 0;
+    uint64_t const allocs_before = alloc_total_count();
+    auto const start = get_time();
+    while (secs < args.min_time) {
+      for (uint64_t i = 0; i < reps; i++)
+        f();
+      calls += reps;
+      reps *= 2;
+      secs = get_secs_since(start);
+    }
+    uint64_t const allocs = alloc_total_count() - allocs_before;
+
+    uint64_t const ops = calls * ops_per_call;
+    results.push_back(BenchResult{kernel, input, ops, secs * 1e9 / ops, (double)allocs / ops});
+  }
+
+  void print(ostream& out) const {
+    bool const allocs = alloc_stats_enabled();
+    char const sep = args.csv ? ',' : '\t';
+    out << "kernel" << sep << "input" << sep << "ops" << sep << "ns/op" << sep << "allocs/op" << endl;
+    for (auto const& r : results) {
+      out << r.kernel << sep << r.input << sep << r.ops << sep
+          << fixed << setprecision(1) << r.ns_per_op << sep;
+      if (allocs)
+        out << setprecision(2) << r.allocs_per_op;
+      else
+        out << "-";
+      out << endl;
+    }
+  }
+};
+
+//determinization config for one update mode without any optimizations
+DetConf bench_detconf(Aut<string> const& aut, UpdateMode mode) {
+  DetConf dc;
+  dc.update = mode;
+  dc.aut_states = to_bitset<nba_bitset>(aut.states());
+  dc.aut_acc    = to_bitset<nba_bitset>( aut.states() | ranges::view::remove_if(
+                    [&](state_t s){ return !aut.state_buchi_accepting(s); }));
+  dc.aut_mat = get_adjmat(aut);
+  dc.maxsets = aut.num_states() + 1;
+
+  auto const scci = get_sccs(aut.states(), aut_succ(aut));
+  dc.sets = calc_detconfsets(dc, scci, ba_scc_classify_acc(aut, scci), ba_scc_classify_det(aut, scci));
+  return dc;
+}
+
+//first (at most) n states reachable from the initial state in BFS order.
+//complete is set if there are no further states
+vector<DetState> sample_detstates(Aut<string> const& aut, DetConf const& dc, size_t n, bool& complete) {
+  nba_bitset initset = 0;
+  initset[aut.get_init()] = 1;
+
+  vector<DetState> ret{DetState(dc, initset)};
+  unordered_set<DetState> seen{ret.front()};
+  complete = true;
+  for (size_t i = 0; i < ret.size(); i++) {
+    for (unsigned x = 0; x < aut.num_syms(); x++) {
+      auto suc = ret[i].succ(dc, x).first;
+      if (seen.count(suc))
+        continue;
+      if (ret.size() >= n) {
+        complete = false;
+        return ret;
+      }
+      seen.insert(suc);
+      ret.push_back(move(suc));
+    }
+  }
+  return ret;
+}
+
+void bench_automaton(Runner& run, Args const& args, string const& name,
+                     string_view chunk, Aut<string> const& aut) {
+  unsigned const nsyms = aut.num_syms();
+  size_t const n = args.sample;
+
+  run.run("hoa_parse", name, 1, [&]() { keep(parse_hoa(chunk)); });
+
+  // -- graph algorithms on the NBA --
+  run.run("get_sccs", name, 1, [&]() { keep(get_sccs(aut.states(), aut_succ(aut))); });
+  run.run("ba_direct_sim", name, 1, [&]() { keep(ba_direct_sim(aut)); });
+
+  // -- powerset successors --
+  auto const mat = get_adjmat(aut);
+  if (run.wanted("powersucc")) {
+    auto const ps = powerset_construction(aut, mat);
+    vector<nba_bitset> sets;
+    for (auto const s : ps.states()) {
+      if (sets.size() >= n)
+        break;
+      sets.push_back(ps.tag.geti(s));
+    }
+    run.run("powersucc", name, sets.size() * nsyms, [&]() {
+      for (auto const& set : sets)
+        for (unsigned x = 0; x < nsyms; x++)
+          keep(powersucc(mat, set, x));
+    });
+  }
+
+  // -- macrostates --
+  array<string, 3> const modes{"muellerschupp", "safra", "fullmerge"};
+  bool complete = false; //whether the sample covers the whole DPA (for MUELLERSCHUPP)
+  vector<DetState> sample;
+  for (int m = 0; m < static_cast<int>(UpdateMode::num); m++) {
+    auto const mode = static_cast<UpdateMode>(m);
+    auto const dc = bench_detconf(aut, mode);
+    bool allstates = false;
+    auto const states = sample_detstates(aut, dc, n, allstates);
+    if (mode == UpdateMode::MUELLERSCHUPP) {
+      sample = states;
+      complete = allstates;
+    }
+
+    run.run("detstate_succ/" + modes.at(m), name, states.size() * nsyms, [&]() {
+      for (auto const& st : states)
+        for (unsigned x = 0; x < nsyms; x++)
+          keep(st.succ(dc, x));
+    });
+  }
+
+  run.run("hash_detstate", name, sample.size(), [&]() {
+    for (auto const& st : sample)
+      keep(std::hash<DetState>()(st));
+  });
+
+  vector<tree_history> hists;
+  for (auto const& st : sample)
+    hists.push_back(st.to_tree_history());
+  run.run("trie_put", name, hists.size(), [&]() {
+    trie_map<nba_bitset, DetState> trie;
+    for (size_t i = 0; i < hists.size(); i++)
+      trie.put(hists[i], sample[i]);
+    keep(trie);
+  });
+  trie_map<nba_bitset, DetState> trie;
+  for (size_t i = 0; i < hists.size(); i++)
+    trie.put(hists[i], sample[i]);
+  run.run("trie_traverse", name, hists.size(), [&]() {
+    for (auto const& h : hists)
+      keep(trie.traverse(h));
+  });
+
+  // -- kernels on the resulting DPA, only if it is small enough --
+  if (!complete || !(run.wanted("get_equiv_states") || run.wanted("hoa_print")))
+    return;
+  auto pa = determinize(aut, bench_detconf(aut, UpdateMode::MUELLERSCHUPP));
+  run.run("hoa_print", name, 1, [&]() {
+    stringstream ss;
+    print_aut(pa, ss);
+    keep(ss);
+  });
+  pa.make_colored();
+  pa.make_complete();
+  run.run("get_equiv_states", name, 1, [&]() { keep(get_equiv_states(pa)); });
+}
+
+int main(int argc, char *argv[]) {
+  auto const log = spd::stderr_logger_mt("log");
+  spd::set_pattern("[%Y-%m-%d %H:%M:%S %z] [%l] %v");
+  spd::set_level(spd::level::info);
+
+  auto args = parse_args(argc, argv);
+  if (args.files.empty()) {
+#ifdef NBAUTILS_BENCH_DIR
+    args.files = hoa_files_in(NBAUTILS_BENCH_DIR);
+#else
+    log->error("No input files given!");
+    exit(1);
+#endif
+  }
+
+  Runner run(args);
+  for (auto const& file : args.files) {
+    string const base = file.substr(file.find_last_of('/') + 1);
+    MappedInput const input(file);
+    string_view const buf = input.data();
+
+    size_t pos = 0;
+    int i = 0;
+    string_view chunk;
+    while (!(chunk = next_hoa_chunk(buf, pos)).empty()) {
+      string const name = i ? base + "#" + to_string(i) : base;
+      i++;
+
+      Aut<string> aut;
+      try {
+        aut = parse_hoa(chunk);
+      } catch (std::exception& e) {
+        log->warn("skipping {}: {}", name, e.what());
+        continue;
+      }
+      if (!aut.is_buchi() || aut.num_states() == 0
+          || ranges::max(aut.states()) >= max_nba_states) {
+        log->warn("skipping {}, not a (small enough) NBA", name);
+        continue;
+      }
+
+      log->info("benchmarking {}", name);
+      bench_automaton(run, args, name, chunk, aut);
+    }
+  }
+
+  run.print(cout);
+}
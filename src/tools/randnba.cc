@@ -0,0 +1,86 @@
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+using namespace std;
+
+#include <args.hxx>
+
+#include "aut.hh"
+#include "io.hh"
+#include "randaut.hh"
+
+using namespace nbautils;
+
+//randnba - print seeded random NBAs in HOA format.
+//for scaling experiments, states and APs can be lists: for each combination
+//COUNT automata are generated, with consecutive seeds starting at SEED.
+
+vector<unsigned> parse_list(string const& s) {
+  vector<unsigned> ret;
+  stringstream ss(s);
+  string it;
+  while (getline(ss, it, ','))
+    ret.push_back(stoul(it));
+  return ret;
+}
+
+int main(int argc, char *argv[]) {
+  args::ArgumentParser parser("randnba - generate random nondeterministic Büchi automata", "");
+  args::HelpFlag help(parser, "help", "Display this help menu", {'h', "help"});
+
+  args::ValueFlag<string> states(parser, "N,...", "Number(s) of states (default: 10)",
+      {'n', "states"}, "10");
+  args::ValueFlag<string> aps(parser, "N,...", "Number(s) of atomic propositions (default: 2)",
+      {'a', "aps"}, "2");
+  args::ValueFlag<double> density(parser, "P", "Probability that two states are connected (default: 0.2)",
+      {'e', "density"}, 0.2);
+  args::ValueFlag<double> acc(parser, "P", "Probability that a state is accepting (default: 0.3)",
+      {'A', "acc"}, 0.3);
+  args::ValueFlag<unsigned> sccs(parser, "N", "Chain of N strongly connected blocks (default: 0 = unstructured)",
+      {'c', "sccs"}, 0);
+  args::ValueFlag<double> det(parser, "P", "Fraction of deterministic states (default: 0)",
+      {'d', "det"}, 0);
+  args::ValueFlag<uint64_t> seed(parser, "SEED", "Seed of first automaton (default: 0)",
+      {'s', "seed"}, 0);
+  args::ValueFlag<unsigned> count(parser, "COUNT", "Automata per combination of states and APs (default: 1)",
+      {'N', "count"}, 1);
+
+  try {
+    parser.ParseCLI(argc, argv);
+  } catch (args::Help&) {
+    std::cout << parser;
+    exit(0);
+  } catch (args::ParseError& e) {
+    std::cerr << e.what() << std::endl;
+    std::cerr << parser;
+    exit(1);
+  } catch (args::ValidationError& e) {
+    std::cerr << e.what() << std::endl;
+    std::cerr << parser;
+    exit(1);
+  }
+
+  try {
+    RandNBAParams p;
+    p.density = args::get(density);
+    p.acc = args::get(acc);
+    p.sccs = args::get(sccs);
+    p.det = args::get(det);
+    p.seed = args::get(seed);
+
+    for (auto const n : parse_list(args::get(states))) {
+      for (auto const k : parse_list(args::get(aps))) {
+        p.states = n;
+        p.aps = k;
+        for (unsigned i = 0; i < args::get(count); i++) {
+          print_aut(random_nba(p));
+          p.seed++;
+        }
+      }
+    }
+  } catch (std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    exit(1);
+  }
+}
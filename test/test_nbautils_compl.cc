@@ -0,0 +1,83 @@
+#include <catch.hpp>
+
+#include <set>
+#include <string>
+#include <sstream>
+
+#include "compl/compl_otf.hh"
+#include "randaut.hh"
+
+using namespace nbautils;
+using namespace cmpl;
+using namespace std;
+
+namespace {
+
+auto random_input(uint64_t seed) {
+  RandNBAParams p;
+  p.states = 2 + seed % 5;
+  p.aps = 1 + seed % 2;
+  p.density = 0.3;
+  p.seed = seed;
+  auto aut = random_nba(p);
+  for (auto const s : aut.states())
+    if (!aut.has_pri(s))
+      aut.set_pri(s, 1);
+  return aut;
+}
+
+string tag_str(ComplAut const& aut, state_t p) {
+  stringstream ss;
+  aut.print_state_tag(ss, p);
+  return ss.str();
+}
+
+// states and edges in terms of the tags, independent of the numbering
+set<string> by_tags(ComplAut const& aut) {
+  set<string> ret;
+  for (auto const p : aut.states()) {
+    ret.insert("S " + tag_str(aut, p) + " " + to_string(aut.get_pri(p)));
+    for (auto const x : aut.state_outsyms(p))
+      for (auto const q : aut.succ(p, x))
+        ret.insert("E " + tag_str(aut, p) + " " + to_string(x) + " " + tag_str(aut, q));
+  }
+  return ret;
+}
+
+// states with their tags in order of their numbers
+string numbering(ComplAut const& aut) {
+  string ret;
+  for (auto const p : aut.states())
+    ret += to_string(p) + " " + tag_str(aut, p) + "\n";
+  return ret;
+}
+
+}  // namespace
+
+TEST_CASE("On-the-fly complementation gives the phased constructions") {
+  for (uint64_t seed = 0; seed < 20; seed++) {
+    auto const aut = random_input(seed);
+    auto const mat = get_adjmat(aut);
+
+    auto const al = al_construction(aut, mat);
+    auto const ps = compl_construction(aut, mat);
+    auto const psopt = compl_construction_opt(aut, mat);
+    REQUIRE(by_tags(compl_construction_otf(aut, mat, ComplConstr::al)) == by_tags(al));
+    REQUIRE(by_tags(compl_construction_otf(aut, mat, ComplConstr::ps)) == by_tags(ps));
+    REQUIRE(by_tags(compl_construction_otf(aut, mat, ComplConstr::ps_opt)) == by_tags(psopt));
+  }
+}
+
+TEST_CASE("On-the-fly complementation does not depend on the number of threads") {
+  for (uint64_t seed = 0; seed < 20; seed++) {
+    auto const aut = random_input(seed);
+    auto const mat = get_adjmat(aut);
+
+    for (int c = 0; c < 3; c++) {
+      auto const one = compl_construction_otf(aut, mat, ComplConstr(c), 1);
+      auto const four = compl_construction_otf(aut, mat, ComplConstr(c), 4);
+      REQUIRE(numbering(four) == numbering(one));
+      REQUIRE(by_tags(four) == by_tags(one));
+    }
+  }
+}
@@ -0,0 +1,56 @@
+#include <catch.hpp>
+
+#include <string>
+
+#include "hoa_reader.hh"
+
+using namespace nbautils;
+using namespace std;
+
+namespace {
+
+// a request automaton with a nested comment and strings containing terminators
+string const hoa =
+  "HOA: v1\n"
+  "name: \"a /* b --END-- \\\" c\"\n"
+  "/* comment /* nested --END-- */ \"quote */\n"
+  "States: 1\nStart: 0\nAP: 1 \"p \\\\ q\"\nacc-name: Buchi\nAcceptance: 1 Inf(0)\n"
+  "--BODY--\nState: 0 {0}\n[0] 0\n[!0] 0\n--END--\n";
+
+}  // namespace
+
+TEST_CASE("HOA chunks are found in complete input") {
+  string const input = hoa + hoa;
+  size_t pos = 0;
+  string_view const chunk = next_hoa_chunk(input, pos);
+  REQUIRE(chunk == string_view(hoa).substr(0, hoa.size()-1));
+
+  auto const aut = parse_hoa(chunk);
+  REQUIRE(aut.get_name() == "a /* b --END-- \" c");
+  REQUIRE(aut.get_aps() == vector<string>{"p \\ q"});
+  REQUIRE(aut.num_states() == 1);
+}
+
+TEST_CASE("HOA chunks need more input while incomplete") {
+  //as the service mode does, feed the request one byte at a time
+  string buf;
+  size_t pos = 0;
+  for (size_t i = 0; i < hoa.size()-1; i++) {
+    buf += hoa[i];
+    size_t const start = pos;
+    string_view const chunk = next_hoa_chunk(buf, pos, false);
+    if (i+1 < hoa.size()-1) {
+      REQUIRE(chunk.empty());
+      REQUIRE(pos == start);
+    } else {
+      REQUIRE(chunk == buf);
+      REQUIRE(pos == buf.size());
+    }
+  }
+
+  //with complete input, an unterminated string or comment is an error
+  pos = 0;
+  REQUIRE_THROWS(next_hoa_chunk("HOA: v1 name: \"abc", pos));
+  pos = 0;
+  REQUIRE_THROWS(next_hoa_chunk("HOA: v1 /* abc", pos));
+}
@@ -0,0 +1,90 @@
+#include <catch.hpp>
+
+#include <map>
+#include <vector>
+#include <utility>
+
+#include "compl/compl_incl.hh"
+#include "randaut.hh"
+
+using namespace nbautils;
+using namespace cmpl;
+using namespace std;
+
+namespace {
+
+auto random_input(unsigned states, uint64_t seed) {
+  RandNBAParams p;
+  p.states = states;
+  p.aps = 1;
+  p.density = 0.4;
+  p.seed = seed;
+  auto aut = random_nba(p);
+  for (auto const s : aut.states())
+    if (!aut.has_pri(s))
+      aut.set_pri(s, 1);
+  return aut;
+}
+
+// whether the product of nba a and the complete complementary automaton c has no
+// accepting cycle, i.e. no SCC containing an edge and accepting states of both
+bool product_empty(auto const& a, ComplAut const& c) {
+  map<pair<state_t, state_t>, state_t> ids;
+  vector<pair<state_t, state_t>> sts;
+  auto const get = [&](state_t p, state_t q) {
+    auto const it = ids.emplace(make_pair(p, q), sts.size());
+    if (it.second)
+      sts.emplace_back(p, q);
+    return it.first->second;
+  };
+  auto const succs = [&](state_t s) {
+    vector<state_t> ret;
+    auto const pq = sts[s];
+    for (auto const x : a.state_outsyms(pq.first))
+      if (c.state_has_outsym(pq.second, x))
+        for (auto const p : a.succ(pq.first, x))
+          for (auto const q : c.succ(pq.second, x))
+            ret.push_back(get(p, q));
+    return ret;
+  };
+
+  get(a.get_init(), c.get_init());
+  for (state_t s = 0; s < sts.size(); s++)
+    succs(s);
+  vector<state_t> all;
+  for (state_t s = 0; s < sts.size(); s++)
+    all.push_back(s);
+
+  auto const scci = get_sccs(all, succs);
+  for (auto const& scc : scci.sccs) {
+    bool cycle = false, acca = false, accc = false;
+    for (auto const s : scc.second) {
+      for (auto const t : succs(s))
+        cycle |= scci.scc_of.at(t) == scc.first;
+      acca |= a.state_buchi_accepting(sts[s].first);
+      accc |= c.get_pri(sts[s].second) == 0;
+    }
+    if (cycle && acca && accc)
+      return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+TEST_CASE("Inclusion agrees with emptiness of the product with the complement") {
+  for (uint64_t seed = 0; seed < 20; seed++) {
+    auto const a = random_input(2 + seed % 5, seed);
+    auto const b = seed % 4 == 0 ? a : random_input(2 + (seed / 3) % 4, seed + 1000);
+    auto const mat = get_adjmat(b);
+
+    for (int c = 0; c < 3; c++) {
+      auto const res = nba_inclusion(a, b, ComplConstr(c));
+      auto const compl_b = compl_construction_otf(b, mat, ComplConstr(c));
+      REQUIRE(res.included == product_empty(a, compl_b));
+      REQUIRE(res.complStates <= compl_b.num_states());
+      if (!res.included)
+        REQUIRE(!res.loop.empty());
+    }
+  }
+}
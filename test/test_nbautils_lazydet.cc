@@ -0,0 +1,92 @@
+#include <catch.hpp>
+
+#include <queue>
+#include <vector>
+
+#include "aut.hh"
+#include "det.hh"
+#include "lazydet.hh"
+#include "preproc.hh"
+#include "randaut.hh"
+
+using namespace nbautils;
+using namespace std;
+
+namespace {
+
+auto random_input(uint64_t seed) {
+  RandNBAParams p;
+  p.states = 2 + seed % 8;
+  p.aps = 1 + seed % 2;
+  p.density = 0.2;
+  p.seed = seed;
+  auto aut = random_nba(p);
+  for (auto const s : aut.states())
+    if (!aut.has_pri(s))
+      aut.set_pri(s, 1);
+  return aut;
+}
+
+DetConf random_detconf(auto const& aut, uint64_t seed) {
+  DetConf dc;
+  dc.aut_mat = get_adjmat(aut);
+  for (auto const s : aut.states()) {
+    dc.aut_states[s] = 1;
+    if (aut.state_buchi_accepting(s))
+      dc.aut_acc[s] = 1;
+  }
+  dc.sep_rej = seed % 2;
+  dc.sep_acc = seed % 3 == 0;
+  dc.sep_mix = seed % 4 == 0;
+  dc.update = UpdateMode(seed % 3);
+  auto const scci = get_sccs(aut.states(), aut_succ(aut));
+  dc.sets = calc_detconfsets(dc, scci, ba_scc_classify_acc(aut, scci), ba_scc_classify_det(aut, scci));
+  return dc;
+}
+
+}  // namespace
+
+TEST_CASE("LazyDPA explores the same automaton as determinize") {
+  for (uint64_t seed = 0; seed < 40; seed++) {
+    auto const aut = random_input(seed);
+    auto const dc = random_detconf(aut, seed);
+    auto const pa = determinize(aut, dc);
+
+    nba_bitset initset = 0;
+    initset[aut.get_init()] = 1;
+    LazyDPA lazy(dc, initset, seed % 2 ? 3 : 1000); //small cache drops successors
+    REQUIRE(lazy.num_syms() == pa.num_syms());
+    REQUIRE(pa.tag.get(lazy.state(lazy.initial())) == pa.get_init());
+
+    //twice, the second time successors are partly recomputed
+    for (int pass = 0; pass < 2; pass++) {
+      vector<bool> seen(1, true);
+      queue<state_t> bfsq;
+      bfsq.push(lazy.initial());
+      while (!bfsq.empty()) {
+        auto const s = bfsq.front();
+        bfsq.pop();
+        auto const p = pa.tag.get(lazy.state(s));
+        for (size_t x = 0; x < lazy.num_syms(); x++) {
+          auto const suc = lazy.successor(s, x);
+          auto const edges = pa.succ_edges(p, x);
+          if (suc.first == LazyDPA::none) {
+            REQUIRE(edges.empty());
+            continue;
+          }
+          REQUIRE(edges.size() == 1);
+          REQUIRE(pa.tag.geti(edges.begin()->first) == lazy.state(suc.first));
+          REQUIRE(edges.begin()->second == suc.second);
+
+          if (suc.first >= seen.size())
+            seen.resize(suc.first + 1, false);
+          if (!seen[suc.first]) {
+            seen[suc.first] = true;
+            bfsq.push(suc.first);
+          }
+        }
+      }
+    }
+    REQUIRE(lazy.num_states() == pa.num_states());
+  }
+}
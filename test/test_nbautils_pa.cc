@@ -0,0 +1,106 @@
+#include <catch.hpp>
+
+#include <random>
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+#include "aut.hh"
+#include "pa.hh"
+
+using namespace nbautils;
+using namespace std;
+
+namespace {
+
+using priord_t = vector<pair<bool,int>>;
+
+// reference: the ordering as explicit list of (side, good priority), updated by moving
+// the pairs of the other side below the one whose bad priority fired
+pair<priord_t, int> ref_succ(priord_t ord, int pl, int pr, bool fulldown) {
+  for (size_t i = 0; i < ord.size(); i++) {
+    int const p = ord[i].first ? pr : pl;
+    if (ord[i].second == p)
+      return make_pair(ord, 2*(i+1));
+    if (ord[i].second-1 == p) {
+      auto last = ord.end();
+      if (!fulldown) {
+        last = ord.begin() + i;
+        while (last != ord.end() && last->first == ord[i].first)
+          ++last;
+        if (last != ord.end())
+          ++last;
+      }
+      bool const side = ord[i].first;
+      stable_partition(ord.begin() + i, last, [side](auto const& t){ return t.first != side; });
+      return make_pair(ord, 2*i+1);
+    }
+  }
+  return make_pair(ord, -1);
+}
+
+template<typename Sides>
+void check_random_steps(mt19937& rnd, int lmin, int lmax, int rmin, int rmax, int steps) {
+  PAProdConf const conf(lmin, lmax, rmin, rmax);
+  auto s = conf.initial<Sides>(0, 0);
+  auto ord = conf.priord(s);
+  for (int i = 0; i < steps; i++) {
+    int const pl = lmin + rnd() % (lmax - lmin + 1);
+    int const pr = rmin + rnd() % (rmax - rmin + 1);
+    bool const fulldown = rnd() % 2;
+    auto const suc = conf.succ(s, 1, pl, 2, pr, fulldown);
+    auto const ref = ref_succ(ord, pl, pr, fulldown);
+    REQUIRE(suc.second == ref.second);
+    REQUIRE(conf.priord(suc.first) == ref.first);
+    s = suc.first;
+    ord = ref.first;
+  }
+}
+
+Aut<int> random_dpa(mt19937& rnd, unsigned maxpri) {
+  Aut<int> aut(false, "random", {"p"}, 0);
+  aut.set_patype(PAType::MIN_EVEN);
+  unsigned const n = 1 + rnd() % 8;
+  for (unsigned i = 1; i < n; i++)
+    aut.add_state(i);
+  for (unsigned i = 0; i < n; i++)
+    for (auto const x : aut.syms())
+      if (rnd() % 6)
+        aut.add_edge(i, x, rnd() % n, rnd() % maxpri);
+  return aut;
+}
+
+}  // namespace
+
+TEST_CASE("Parity product successors match the explicit ordering") {
+  mt19937 rnd(1);
+  //60000 steps per representation, the larger ranges do not fit into the inline words
+  for (int k = 0; k < 200; k++) {
+    int const lmin = rnd() % 3;
+    int const rmin = rnd() % 3;
+    int const lmax = lmin + rnd() % (k < 100 ? 20 : 300);
+    int const rmax = rmin + rnd() % (k < 100 ? 20 : 300);
+    check_random_steps<PAProdSides>(rnd, lmin, lmax, rmin, rmax, 300);
+    if (k < 100)
+      check_random_steps<PAProdSidesInline>(rnd, lmin, lmax, rmin, rmax, 600);
+  }
+}
+
+TEST_CASE("Parity product is the same with inline and allocated orderings") {
+  mt19937 rnd(2);
+  for (int k = 0; k < 100; k++) {
+    auto const a = random_dpa(rnd, 10);
+    auto const b = random_dpa(rnd, 10);
+    PAProdConf const conf(a.pri_bounds().first, a.pri_bounds().second,
+                          b.pri_bounds().first, b.pri_bounds().second);
+    auto const inl = pa_union_with<PAProdSidesInline>(a, b, conf, true);
+    auto const gen = pa_union_with<PAProdSides>(a, b, conf, true);
+
+    REQUIRE(inl.num_states() == gen.num_states());
+    for (auto const p : inl.states()) {
+      REQUIRE(inl.tag.geti(p) == gen.tag.geti(p));
+      for (auto const x : inl.syms())
+        REQUIRE(inl.succ_edges(p, x) == gen.succ_edges(p, x));
+    }
+  }
+}